@@ -27,7 +27,7 @@
 /**
  *  Complex Edge Data Type for LP
  **/
-struct LP_EdgeData : public EdgeDataType {
+struct LP_EdgeData : public EdgeDataType<LP_EdgeData> {
 public:
   double weight = 0;
   LP_EdgeData() {}
@@ -36,13 +36,12 @@ public:
     weight = atof(edgeDataString);
   }
 
-  void setEdgeDataFromPtr(EdgeDataType *edgeData) {
-    weight = ((LP_EdgeData *)edgeData)->weight;
+  // Enough digits for createEdgeData() to read back the same weight
+  std::string print() {
+    std::ostringstream s;
+    s << std::setprecision(17) << weight;
+    return s.str();
   }
-
-  void del() {}
-
-  std::string print() { return std::to_string(weight); }
 };
 
 // NOTE : The following typedef is important for the core files (graph.h, IO.h,
@@ -27,7 +27,7 @@
 /**
  *  Simple Edge Data Type for SSSP
  **/
-struct SSSP_EdgeData : public EdgeDataType {
+struct SSSP_EdgeData : public EdgeDataType<SSSP_EdgeData> {
 public:
   long weight = 0;
   SSSP_EdgeData() {}
@@ -36,12 +36,6 @@ public:
     weight = atol(edgeDataString);
   }
 
-  void setEdgeDataFromPtr(EdgeDataType *edgeData) {
-    weight = ((SSSP_EdgeData *)edgeData)->weight;
-  }
-
-  void del() {}
-
   std::string print() { return std::to_string(weight); }
 };
 
@@ -112,21 +112,19 @@ void radixStep(E *A, E *B, bIndexT *Tmp, bint (*BK)[BUCKETS], long numBK,
   bint *oA = (bint *)(BK + blocks);
   bint *oB = (bint *)(BK + 2 * blocks);
 
-  parallel_for_1(long i = 0; i < blocks; i++) {
+  parallel_for(0, blocks, [&](long i) {
     bint od = i * nn;
     long nni = min(max<long>(n - od, 0), nn);
     radixBlock(A + od, B, Tmp + od, cnts + m * i, oB + m * i, od, nni, m,
                extract);
-  }
+  }, 1);
 
   transpose<bint, bint>(cnts, oA).trans(blocks, m);
 
-  long ss;
   if (top)
-    ss = sequence::scan(oA, oA, blocks * m, addF<bint>(), (bint)0);
+    sequence::scan(oA, oA, blocks * m, addF<bint>(), (bint)0);
   else
-    ss = sequence::scanSerial(oA, oA, blocks * m, addF<bint>(), (bint)0);
-  // utils::myAssert(ss == n, "radixStep: sizes don't match");
+    sequence::scanSerial(oA, oA, blocks * m, addF<bint>(), (bint)0);
 
   blockTrans<E, bint>(B, A, oB, oA, cnts).trans(blocks, m);
 
@@ -141,7 +139,7 @@ template <class E, class F> struct eBits {
   long _mask;
   long _offset;
   eBits(long bits, long offset, F f)
-      : _mask((1 << bits) - 1), _offset(offset), _f(f) {}
+      : _f(f), _mask((1 << bits) - 1), _offset(offset) {}
   long operator()(E p) { return _mask & (_f(p) >> _offset); }
 };
 
@@ -176,7 +174,7 @@ void radixLoopTopDown(E *A, E *B, bIndexT *Tmp, bint (*BK)[BUCKETS], long numBK,
     bint *offsets = BK[0];
     long remain = numBK - BUCKETS - 1;
     float y = remain / (float)n;
-    parallel_for(int i = 0; i < BUCKETS; i++) {
+    parallel_for(0, BUCKETS, [&](int i) {
       long segOffset = offsets[i];
       long segNextOffset = (i == BUCKETS - 1) ? n : offsets[i + 1];
       long segLen = segNextOffset - segOffset;
@@ -186,7 +184,7 @@ void radixLoopTopDown(E *A, E *B, bIndexT *Tmp, bint (*BK)[BUCKETS], long numBK,
       radixLoopTopDown(A + segOffset, B + segOffset, Tmp + segOffset,
                        BK + blocksOffset, blockLen, segLen, bits - MAX_RADIX,
                        f);
-    }
+    });
   } else {
     radixLoopBottomUp(A, B, Tmp, BK, numBK, n, bits, false, f);
   }
@@ -222,7 +220,7 @@ void iSortX(E *A, oint *bucketOffsets, long n, long m, bool bottomUp,
     radixStep(A, B, Tmp, BK, numBK, n, (long)1 << bits, true,
               eBits<E, F>(bits, 0, f));
     if (bucketOffsets != NULL) {
-      parallel_for(long i = 0; i < m; i++) bucketOffsets[i] = BK[0][i];
+      parallel_for(0, m, [&](long i) { bucketOffsets[i] = BK[0][i]; });
     }
     return;
   } else if (bottomUp) {
@@ -232,15 +230,15 @@ void iSortX(E *A, oint *bucketOffsets, long n, long m, bool bottomUp,
   }
   if (bucketOffsets != NULL) {
     {
-      parallel_for(long i = 0; i < m; i++) bucketOffsets[i] = n;
+      parallel_for(0, m, [&](long i) { bucketOffsets[i] = n; });
     }
     {
-      parallel_for(long i = 0; i < n - 1; i++) {
+      parallel_for(0, n - 1, [&](long i) {
         long v = f(A[i]);
         long vn = f(A[i + 1]);
         if (v != vn)
           bucketOffsets[vn] = i + 1;
-      }
+      });
     }
     bucketOffsets[f(A[0])] = 0;
     sequence::scanIBack(bucketOffsets, bucketOffsets, m, minF<oint>(), (oint)n);
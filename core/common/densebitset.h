@@ -6,13 +6,16 @@
 
 #ifndef __DENSE_BITSET_HPP__
 #define __DENSE_BITSET_HPP__
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <stdint.h>
 
-typedef uint32_t IdType;
+// Bits are stored in 64-bit words, so that scans can skip 64 unset bits at a
+// time.
+typedef uint64_t IdType;
 
 class DenseBitset {
 public:
@@ -101,17 +104,15 @@ public:
 
   inline const IdType *getArray() const { return array; }
 
+  inline IdType *getArray() { return array; }
+
+  inline IdType numWords() const { return arrlen; }
+
   inline IdType countSetBits() const {
     IdType ret = 0;
 
     for (IdType i = 0; i < arrlen; ++i) {
-      IdType val = 0x0000000000000001;
-      for (unsigned j = 0; j < sizeof(IdType) * 8; ++j) {
-        if (array[i] & val)
-          ++ret;
-
-        val = val << 1;
-      }
+      ret += __builtin_popcountll(array[i]);
     }
 
     return std::min(len, ret);
@@ -132,11 +132,11 @@ template <class vertex, class intT> struct getDegree {
     long _ee = _e;                                                             \
     long _n = _ee - _ss;                                                       \
     long _l = nblocks(_n, _bsize);                                             \
-    parallel_for(long _i = 0; _i < _l; _i++) {                                 \
+    parallel_for(0, _l, [&](long _i) {                                         \
       long _s = _ss + _i * (_bsize);                                           \
       long _e = min(_s + (_bsize), _ee);                                       \
       _body                                                                    \
-    }                                                                          \
+    });                                                                        \
   }
 
 #define blocked_for_withIncrement(_i, _s, _e, _bsize, _body, _incrementBy)     \
@@ -145,11 +145,12 @@ template <class vertex, class intT> struct getDegree {
     long _ee = _e;                                                             \
     long _n = _ee - _ss;                                                       \
     long _l = nblocks(_n, _bsize);                                             \
-    parallel_for(long _i = 0; _i < _l; _i += _incrementBy) {                   \
+    parallel_for(0, nblocks(_l, _incrementBy), [&](long _k) {                  \
+      long _i = _k * (_incrementBy);                                           \
       long _s = _ss + _i * (_bsize);                                           \
       long _e = min(_s + (_bsize), _ee);                                       \
       _body                                                                    \
-    }                                                                          \
+    });                                                                        \
   }
 
 template <class OT, class intT, class F, class G>
@@ -352,7 +353,6 @@ template <class ET, class intT> ET plusScanI(ET *In, ET *Out, intT n) {
 // them as an integer
 // Only optimized when n is a multiple of 512 and Fl is 4byte aligned
 template <class intT> intT sumFlagsSerial(bool *Fl, intT n) {
-  cout << "sumFlagsSerial FL = " << Fl << " n = " << n << endl;
   intT r = 0;
   if (n >= 128 && (n & 511) == 0 && ((long)Fl & 3) == 0) {
     int *IFl = (int *)Fl;
@@ -390,10 +390,7 @@ _seq<ET> pack(ET *Out, bool *Fl, intT s, intT e, F f) {
     return packSerial(Out, Fl, s, e, f);
   intT *Sums = newA(intT, l);
   blocked_for(i, s, e, _F_BSIZE, Sums[i] = sumFlagsSerial(Fl + s, e - s););
-  for (intT i = 0; i < l; i++)
-    cout << "Sums[" << i << "] = " << Sums[i] << endl;
   intT m = plusScan(Sums, Sums, l);
-  cout << "m = " << m << endl;
   if (Out == NULL)
     Out = newA(ET, m);
   blocked_for(i, s, e, _F_BSIZE, packSerial(Out + Sums[i], Fl, s, e, f););
@@ -411,7 +408,7 @@ template <class intT> _seq<intT> packIndex(bool *Fl, intT n) {
 
 template <class ET, class intT, class PRED>
 intT filter(ET *In, ET *Out, bool *Fl, intT n, PRED p) {
-  parallel_for(intT i = 0; i < n; i++) Fl[i] = (bool)p(In[i]);
+  parallel_for(0, n, [&](intT i) { Fl[i] = (bool)p(In[i]); });
   intT m = pack(In, Out, Fl, n);
   return m;
 }
@@ -436,12 +433,30 @@ template <class ET> inline bool CAS(ET *ptr, ET oldv, ET newv) {
   } else if (sizeof(ET) == 8) {
     return __sync_bool_compare_and_swap((long *)ptr, *((long *)&oldv),
                                         *((long *)&newv));
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_16
+  } else if (sizeof(ET) == 16) {
+    // cmpxchg16b, ptr must be 16-byte aligned
+    return __sync_bool_compare_and_swap((unsigned __int128 *)ptr,
+                                        *((unsigned __int128 *)&oldv),
+                                        *((unsigned __int128 *)&newv));
+#endif
   } else {
     std::cout << "CAS bad length : " << sizeof(ET) << std::endl;
     abort();
   }
 }
 
+// Whether CAS() supports values of type ET. 16-byte values need cmpxchg16b
+// (-mcx16).
+template <class ET> struct hasCAS {
+  static const bool value = sizeof(ET) == 1 || sizeof(ET) == 4 ||
+                            sizeof(ET) == 8
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_16
+                            || (sizeof(ET) == 16 && alignof(ET) >= 16)
+#endif
+      ;
+};
+
 template <class ET> inline bool writeMin(ET *a, ET b) {
   ET c;
   bool r = 0;
@@ -501,14 +516,14 @@ inline ulong hashInt(ulong a) {
 // UINT_E_MAX.
 template <class G>
 void remDuplicates(G &get_key, uintE *flags, long m, long n) {
-  parallel_for(size_t i = 0; i < m; i++) {
+  parallel_for(0, m, [&](size_t i) {
     uintE key = get_key(i);
     if (key != UINT_E_MAX && flags[key] == UINT_E_MAX) {
       CAS(&flags[key], (uintE)UINT_E_MAX, static_cast<uintE>(i));
     }
-  }
+  });
   // reset flags
-  parallel_for(size_t i = 0; i < m; i++) {
+  parallel_for(0, m, [&](size_t i) {
     uintE key = get_key(i);
     if (key != UINT_E_MAX) {
       if (flags[key] == i) {     // win
@@ -517,14 +532,14 @@ void remDuplicates(G &get_key, uintE *flags, long m, long n) {
         get_key(i) = UINT_E_MAX; // lost
       }
     }
-  }
+  });
 }
 
 #define granular_for(_i, _start, _end, _cond, _body)                           \
   {                                                                            \
     if (_cond) {                                                               \
       {                                                                        \
-        parallel_for(long _i = _start; _i < _end; _i++) { _body }            \
+        parallel_for(_start, _end, [&](long _i) { _body });                 \
       }                                                                        \
     } else {                                                                   \
       {                                                                        \
@@ -597,7 +612,8 @@ template <typename E> E *new_array_no_init(size_t n, bool touch_pages = false) {
   }
   // a hack to make sure tlb is full for huge pages
   if (touch_pages)
-    parallel_for(size_t i = 0; i < bytes; i = i + (1 << 21))((bool *)r)[i] = 0;
+    parallel_for(0, (bytes + (1 << 21) - 1) >> 21,
+                 [&](size_t i) { ((bool *)r)[i << 21] = 0; });
   return r;
 }
 
@@ -606,7 +622,7 @@ template <typename E> E *new_array(size_t n) {
   E *r = new_array_no_init<E>(n);
   if (!std::is_trivially_default_constructible<E>::value) {
     if (n > 2048)
-      parallel_for(size_t i = 0; i < n; i++) new ((void *)(r + i)) E;
+      parallel_for(0, n, [&](size_t i) { new ((void *)(r + i)) E; });
     else
       for (size_t i = 0; i < n; i++)
         new ((void *)(r + i)) E;
@@ -619,7 +635,7 @@ template <typename E> void delete_array(E *A, size_t n) {
   // C++14 -- suppored by gnu C++11
   if (!std::is_trivially_destructible<E>::value) {
     if (n > 2048)
-      parallel_for(size_t i = 0; i < n; i++) A[i].~E();
+      parallel_for(0, n, [&](size_t i) { A[i].~E(); });
     else
       for (size_t i = 0; i < n; i++)
         A[i].~E();
@@ -675,19 +691,19 @@ template <class T> T *copy_array(T *src, T *target, uintEE size) {
 
 template <class T> T *create_copy(intE n, T *ref) {
   T *temp = newA(T, n);
-  parallel_for(int i = 0; i < n; i++) temp[i] = ref[i];
+  parallel_for(0, n, [&](int i) { temp[i] = ref[i]; });
   // std::copy(ref, ref+n, temp);
   return temp;
 }
 
 template <class T> T **create_copy(intE n, intE s, T **ref) {
   T **temp = newA(T *, n);
-  parallel_for(int i = 0; i < n; i++) {
+  parallel_for(0, n, [&](int i) {
     temp[i] = newA(T, s);
     for (int j = 0; j < s; j++) {
       temp[i][j] = ref[i][j];
     }
-  }
+  });
   // std::copy(ref, ref+n, temp);
   return temp;
 }
@@ -27,42 +27,58 @@
 #ifndef _PARALLEL_H
 #define _PARALLEL_H
 
-#if defined(CILK)
+// All backends expose the same interface:
+//   parallel_for(start, end, f [, granularity]) calls f(i) for every i in
+//     [start, end). A granularity of 0 lets the backend pick the grain size.
+//   par_do(left, right) runs the two callables in parallel and joins.
+//   getWorkers() / setWorkers(n) query and set the number of workers.
+//   getWorkerId() returns the id, in [0, getWorkers()), of the calling worker.
+//   AsyncTask::start(f) runs f() concurrently with the caller until join().
+//     With the default backend, f is a job of the worker pool, so its
+//     parallel loops use the pool. It runs in join() when no idle worker
+//     picks it up (for example with a single worker). The other backends run
+//     f on a separate std::thread. Under OpenMP, its loops are serial so that
+//     they do not compete with the team of the caller.
+#if defined(CILK) || defined(CILKP)
 #include <cilk/cilk.h>
-#include <cilk/reducer_opadd.h>
-#define parallel_main main
-#define parallel_for cilk_for
-// #define parallel_for for
-#define parallel_for_1 _Pragma("cilk_grainsize = 1") cilk_for
-#define parallel_for_256 _Pragma("cilk_grainsize = 256") cilk_for
 #include <cilk/cilk_api.h>
 #include <cstdlib>
 #include <iostream>
 #include <sstream>
-static int getWorkers() { return __cilkrts_get_nworkers(); }
-static void setWorkers(int n) {
-  __cilkrts_end_cilk();
-  //__cilkrts_init();
-  std::stringstream ss;
-  ss << n;
-  if (0 != __cilkrts_set_param("nworkers", ss.str().c_str())) {
-    std::cerr << "failed to set worker count!" << std::endl;
-    std::abort();
+#include <thread>
+#define parallel_main main
+template <class F>
+inline void parallel_for(long start, long end, F f, long granularity = 0) {
+  if (granularity == 1) {
+#if defined(CILK)
+    _Pragma("cilk_grainsize = 1") cilk_for(long i = start; i < end; i++) f(i);
+#else
+    _Pragma("cilk grainsize = 1") cilk_for(long i = start; i < end; i++) f(i);
+#endif
+  } else if (granularity == 256) {
+#if defined(CILK)
+    _Pragma("cilk_grainsize = 256") cilk_for(long i = start; i < end; i++) f(i);
+#else
+    _Pragma("cilk grainsize = 256") cilk_for(long i = start; i < end; i++) f(i);
+#endif
+  } else {
+    cilk_for(long i = start; i < end; i++) f(i);
   }
 }
-
-// intel cilk+
-#elif defined(CILKP)
-#include <cilk/cilk.h>
-#define parallel_for cilk_for
-#define parallel_main main
-#define parallel_for_1 _Pragma("cilk grainsize = 1") cilk_for
-#define parallel_for_256 _Pragma("cilk grainsize = 256") cilk_for
-#include <cilk/cilk_api.h>
-#include <cstdlib>
-#include <iostream>
-#include <sstream>
+template <class Lf, class Rf> inline void par_do(Lf left, Rf right) {
+  cilk_spawn left();
+  right();
+  cilk_sync;
+}
 static int getWorkers() { return __cilkrts_get_nworkers(); }
+static int getWorkerId() { return __cilkrts_get_worker_number(); }
+class AsyncTask {
+  std::thread thread;
+
+public:
+  template <class F> void start(F f) { thread = std::thread(f); }
+  void join() { thread.join(); }
+};
 static void setWorkers(int n) {
   __cilkrts_end_cilk();
   //__cilkrts_init();
@@ -77,26 +93,96 @@ static void setWorkers(int n) {
 // openmp
 #elif defined(OPENMP)
 #include <omp.h>
-#define cilk_spawn
-#define cilk_sync
+#include <thread>
 #define parallel_main main
-#define parallel_for _Pragma("omp parallel for") for
-#define parallel_for_1 _Pragma("omp parallel for schedule (static,1)") for
-#define parallel_for_256 _Pragma("omp parallel for schedule (static,256)") for
+template <class F>
+inline void parallel_for(long start, long end, F f, long granularity = 0) {
+  if (granularity > 0) {
+    _Pragma("omp parallel for schedule (dynamic)") for (long i = start;
+                                                         i < end; i++) f(i);
+  } else {
+    _Pragma("omp parallel for") for (long i = start; i < end; i++) f(i);
+  }
+}
+template <class Lf, class Rf> inline void par_do(Lf left, Rf right) {
+  _Pragma("omp parallel sections num_threads(2)") {
+    _Pragma("omp section") left();
+    _Pragma("omp section") right();
+  }
+}
 static int getWorkers() { return omp_get_max_threads(); }
-static void setWorkers(int n) { omp_set_num_threads(n); }
+// Nested regions run with a single thread (setWorkers() disables nesting), so
+// omp_get_thread_num() would be 0 in them. The id is the thread number in the
+// outermost region instead.
+static int getWorkerId() {
+  int id = omp_get_ancestor_thread_num(1);
+  return id < 0 ? 0 : id;
+}
+static void setWorkers(int n) {
+  omp_set_num_threads(n);
+  omp_set_max_active_levels(1);
+}
+class AsyncTask {
+  std::thread thread;
 
-// c++
-#else
-#define cilk_spawn
-#define cilk_sync
+public:
+  template <class F> void start(F f) {
+    thread = std::thread([f]() {
+      omp_set_num_threads(1);
+      f();
+    });
+  }
+  void join() { thread.join(); }
+};
+
+// serial
+#elif defined(SERIAL)
+#include <thread>
 #define parallel_main main
-#define parallel_for for
-#define parallel_for_1 for
-#define parallel_for_256 for
-#define cilk_for for
+template <class F>
+inline void parallel_for(long start, long end, F f, long granularity = 0) {
+  for (long i = start; i < end; i++)
+    f(i);
+}
+template <class Lf, class Rf> inline void par_do(Lf left, Rf right) {
+  left();
+  right();
+}
 static int getWorkers() { return 1; }
+static int getWorkerId() { return 0; }
 static void setWorkers(int n) {}
+class AsyncTask {
+  std::thread thread;
+
+public:
+  template <class F> void start(F f) { thread = std::thread(f); }
+  void join() { thread.join(); }
+};
+
+// c++ (std::thread work-stealing scheduler)
+#else
+#include "scheduler.h"
+#define parallel_main main
+template <class F>
+inline void parallel_for(long start, long end, F f, long granularity = 0) {
+  scheduler::parallelFor(start, end, f, granularity);
+}
+template <class Lf, class Rf> inline void par_do(Lf left, Rf right) {
+  scheduler::parDo(left, right);
+}
+static int getWorkers() { return scheduler::getNumWorkers(); }
+static int getWorkerId() { return scheduler::getWorkerId(); }
+static void setWorkers(int n) { scheduler::setNumWorkers(n); }
+class AsyncTask {
+  scheduler::AsyncJob job;
+
+public:
+  template <class F> void start(F f) {
+    job.f = f;
+    scheduler::startAsync(job);
+  }
+  void join() { scheduler::joinAsync(job); }
+};
 
 #endif
 
@@ -72,9 +72,9 @@ void quickSort(E *A, intType n, BinPred f) {
         std::swap(*M, *(L++));
       M++;
     }
-    cilk_spawn quickSort(A, L - A, f);
-    quickSort(M, A + n - M, f); // Exclude all elts that equal pivot
-    cilk_sync;
+    // Exclude all elts that equal pivot
+    par_do([&]() { quickSort(A, L - A, f); },
+           [&]() { quickSort(M, A + n - M, f); });
   }
 }
 
@@ -0,0 +1,409 @@
+// Copyright (c) 2020 Mugilan Mariappan, Joanna Che and Keval Vora.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+// Work-stealing fork-join scheduler built only on std::thread and
+// std::atomic. It is the default backend of parallel.h when neither Cilk nor
+// OpenMP is selected. Each worker owns a deque of pending jobs: the owner
+// pushes and pops at the bottom, idle workers steal from the top of a random
+// victim (Arora, Blumofe and Plaxton). parallel_for recursively splits its
+// range in halves and forks the upper half until a range fits the grain size.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace scheduler {
+
+struct Job {
+  virtual void execute() = 0;
+  std::atomic<bool> done{false};
+  virtual ~Job() = default;
+};
+
+template <class F> struct FunctionJob : public Job {
+  F &f;
+  FunctionJob(F &_f) : f(_f) {}
+  void execute() {
+    f();
+    done.store(true, std::memory_order_release);
+  }
+};
+
+// Job of an AsyncTask (see parallel.h). It owns its function since the
+// submitter returns before the job runs.
+struct AsyncJob : public Job {
+  std::function<void()> f;
+  bool queued = false;
+  void execute() {
+    f();
+    done.store(true, std::memory_order_release);
+  }
+};
+
+// Fixed capacity deque. When the deque is full, fork() runs the job inline,
+// so the capacity only bounds the amount of exposed parallelism.
+class WorkDeque {
+  static const unsigned kCapacity = 1 << 12;
+
+  // top (low 32 bits) and tag (high 32 bits) are updated together so that a
+  // thief never succeeds with a stale top after the owner has reset the deque.
+  std::atomic<uint64_t> age;
+  char padding1[64 - sizeof(std::atomic<uint64_t>)];
+  std::atomic<unsigned> bot;
+  char padding2[64 - sizeof(std::atomic<unsigned>)];
+  std::atomic<Job *> jobs[kCapacity];
+
+  static unsigned top(uint64_t a) { return (unsigned)(a & 0xffffffff); }
+  static uint64_t tag(uint64_t a) { return a >> 32; }
+  static uint64_t makeAge(uint64_t t, unsigned tp) { return (t << 32) | tp; }
+
+public:
+  WorkDeque() : age(0), bot(0) {
+    for (unsigned i = 0; i < kCapacity; i++)
+      jobs[i].store(nullptr, std::memory_order_relaxed);
+  }
+
+  bool empty() {
+    return bot.load(std::memory_order_acquire) <=
+           top(age.load(std::memory_order_acquire));
+  }
+
+  // Owner only.
+  bool pushBottom(Job *job) {
+    unsigned local_bot = bot.load(std::memory_order_relaxed);
+    if (local_bot == kCapacity)
+      return false;
+    jobs[local_bot].store(job, std::memory_order_relaxed);
+    bot.store(local_bot + 1, std::memory_order_seq_cst);
+    return true;
+  }
+
+  // Owner only.
+  Job *popBottom() {
+    unsigned local_bot = bot.load(std::memory_order_relaxed);
+    if (local_bot == 0)
+      return nullptr;
+    local_bot--;
+    bot.store(local_bot, std::memory_order_seq_cst);
+    Job *job = jobs[local_bot].load(std::memory_order_relaxed);
+    uint64_t old_age = age.load(std::memory_order_seq_cst);
+    if (local_bot > top(old_age))
+      return job;
+    // At most one job left. Race with the thieves for it and reset the deque.
+    bot.store(0, std::memory_order_seq_cst);
+    uint64_t new_age = makeAge(tag(old_age) + 1, 0);
+    Job *result = nullptr;
+    if (local_bot == top(old_age)) {
+      if (age.compare_exchange_strong(old_age, new_age,
+                                      std::memory_order_seq_cst))
+        result = job;
+      else
+        age.store(new_age, std::memory_order_seq_cst);
+    } else {
+      age.store(new_age, std::memory_order_seq_cst);
+    }
+    return result;
+  }
+
+  // Any thread.
+  Job *popTop() {
+    uint64_t old_age = age.load(std::memory_order_seq_cst);
+    unsigned local_bot = bot.load(std::memory_order_seq_cst);
+    if (local_bot <= top(old_age))
+      return nullptr;
+    Job *job = jobs[top(old_age)].load(std::memory_order_relaxed);
+    uint64_t new_age = makeAge(tag(old_age), top(old_age) + 1);
+    if (age.compare_exchange_strong(old_age, new_age,
+                                    std::memory_order_seq_cst))
+      return job;
+    return nullptr;
+  }
+};
+
+class WorkStealingPool {
+  int num_workers;
+  std::vector<WorkDeque *> deques;
+  std::vector<std::thread> threads;
+  std::atomic<bool> finished;
+
+  // Idle workers go to sleep after repeated failed steals. fork() wakes them
+  // only when somebody is actually sleeping.
+  std::mutex sleep_mutex;
+  std::condition_variable sleep_cv;
+  std::atomic<int> num_sleeping;
+
+  static int &threadId() {
+    static thread_local int id = -1;
+    return id;
+  }
+
+  static uint64_t nextRandom(uint64_t &state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+
+  bool anyWork() {
+    for (int i = 0; i < num_workers; i++)
+      if (!deques[i]->empty())
+        return true;
+    return false;
+  }
+
+  Job *trySteal(int id, uint64_t &rand_state) {
+    int victim = nextRandom(rand_state) % num_workers;
+    if (victim == id)
+      return nullptr;
+    return deques[victim]->popTop();
+  }
+
+  void workerLoop(int id) {
+    threadId() = id;
+    uint64_t rand_state = 0x9e3779b97f4a7c15ULL * (id + 1);
+    int failed_steals = 0;
+    while (!finished.load(std::memory_order_acquire)) {
+      Job *job = trySteal(id, rand_state);
+      if (job != nullptr) {
+        job->execute();
+        failed_steals = 0;
+        continue;
+      }
+      failed_steals++;
+      if (failed_steals < 64 * num_workers) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleep_mutex);
+      num_sleeping.fetch_add(1, std::memory_order_seq_cst);
+      if (!anyWork() && !finished.load(std::memory_order_acquire))
+        sleep_cv.wait_for(lock, std::chrono::milliseconds(10));
+      num_sleeping.fetch_sub(1, std::memory_order_seq_cst);
+      failed_steals = 0;
+    }
+  }
+
+  void wakeSleepers() {
+    if (num_sleeping.load(std::memory_order_seq_cst) > 0) {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+      sleep_cv.notify_all();
+    }
+  }
+
+  // Keep the calling worker busy with other jobs until the stolen job is done.
+  void waitFor(Job &job, int id) {
+    uint64_t rand_state = 0x2545f4914f6cdd1dULL * (id + 1);
+    while (!job.done.load(std::memory_order_acquire)) {
+      Job *other = trySteal(id, rand_state);
+      if (other != nullptr)
+        other->execute();
+      else
+        std::this_thread::yield();
+    }
+  }
+
+public:
+  WorkStealingPool(int _num_workers)
+      : num_workers(std::max(1, _num_workers)), finished(false),
+        num_sleeping(0) {
+    for (int i = 0; i < num_workers; i++)
+      deques.push_back(new WorkDeque());
+    // The thread that creates the pool acts as worker 0.
+    threadId() = 0;
+    for (int i = 1; i < num_workers; i++)
+      threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+  }
+
+  ~WorkStealingPool() {
+    finished.store(true, std::memory_order_release);
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+      sleep_cv.notify_all();
+    }
+    for (auto &t : threads)
+      t.join();
+    for (auto d : deques)
+      delete d;
+    threadId() = -1;
+  }
+
+  int getNumWorkers() const { return num_workers; }
+
+  // Id of the calling worker, or -1 if it does not belong to a pool
+  static int currentWorkerId() { return threadId(); }
+
+  // Threads that do not belong to the pool (or pools with a single worker)
+  // run everything serially.
+  bool isWorkerThread() const {
+    int id = threadId();
+    return id >= 0 && id < num_workers;
+  }
+
+  // Pushes job on the deque of the calling worker, where an idle worker can
+  // steal it while the caller goes on. Returns false if the job could not be
+  // queued (single worker, thread outside of the pool or full deque).
+  bool submit(Job *job) {
+    int id = threadId();
+    if (num_workers == 1 || id < 0 || id >= num_workers ||
+        !deques[id]->pushBottom(job))
+      return false;
+    wakeSleepers();
+    return true;
+  }
+
+  // Waits for a job queued by submit() from the same worker. The fork-joins
+  // started by the worker since then have completed, so the job is either
+  // still at the bottom of its deque or has been stolen.
+  void join(Job &job) {
+    if (job.done.load(std::memory_order_acquire))
+      return;
+    int id = threadId();
+    Job *own = deques[id]->popBottom();
+    if (own != nullptr)
+      own->execute();
+    else
+      waitFor(job, id);
+  }
+
+  template <class Lf, class Rf> void forkJoin(Lf &left, Rf &right) {
+    int id = threadId();
+    if (num_workers == 1 || id < 0 || id >= num_workers) {
+      left();
+      right();
+      return;
+    }
+    FunctionJob<Rf> right_job(right);
+    if (!deques[id]->pushBottom(&right_job)) {
+      left();
+      right();
+      return;
+    }
+    wakeSleepers();
+    left();
+    Job *job = deques[id]->popBottom();
+    if (job != nullptr) {
+      // Nobody stole the right half. Run it here.
+      right();
+    } else {
+      waitFor(right_job, id);
+    }
+  }
+};
+
+inline int defaultNumWorkers() {
+  int n = std::thread::hardware_concurrency();
+  return n > 0 ? n : 1;
+}
+
+inline int &configuredWorkers() {
+  static int workers = defaultNumWorkers();
+  return workers;
+}
+
+inline WorkStealingPool *&poolInstance() {
+  static WorkStealingPool *pool = nullptr;
+  return pool;
+}
+
+inline WorkStealingPool &getPool() {
+  WorkStealingPool *&pool = poolInstance();
+  if (pool == nullptr)
+    pool = new WorkStealingPool(configuredWorkers());
+  return *pool;
+}
+
+// Must not be called from inside a parallel region.
+inline void setNumWorkers(int n) {
+  WorkStealingPool *&pool = poolInstance();
+  if (pool != nullptr) {
+    delete pool;
+    pool = nullptr;
+  }
+  configuredWorkers() = std::max(1, n);
+}
+
+inline int getNumWorkers() { return configuredWorkers(); }
+
+// Threads outside of the pool run parallel loops serially and count as
+// worker 0.
+inline int getWorkerId() {
+  return std::max(0, WorkStealingPool::currentWorkerId());
+}
+
+// A job that is not queued runs in joinAsync()
+inline void startAsync(AsyncJob &job) {
+  job.done.store(false, std::memory_order_relaxed);
+  job.queued = getPool().submit(&job);
+}
+
+inline void joinAsync(AsyncJob &job) {
+  if (job.queued)
+    getPool().join(job);
+  else
+    job.execute();
+}
+
+template <class Lf, class Rf> inline void parDo(Lf left, Rf right) {
+  getPool().forkJoin(left, right);
+}
+
+template <class F>
+void parallelForRecursive(long start, long end, F &f, long granularity) {
+  if (end - start <= granularity) {
+    for (long i = start; i < end; i++)
+      f(i);
+  } else {
+    long mid = start + (end - start) / 2;
+    auto left = [&]() { parallelForRecursive(start, mid, f, granularity); };
+    auto right = [&]() { parallelForRecursive(mid, end, f, granularity); };
+    getPool().forkJoin(left, right);
+  }
+}
+
+// A granularity of 0 picks the Cilk default: min(2048, n / (8 * workers)).
+template <class F>
+inline void parallelFor(long start, long end, F f, long granularity = 0) {
+  if (end <= start)
+    return;
+  long n = end - start;
+  int workers = getNumWorkers();
+  if (granularity <= 0)
+    granularity = std::max(1L, std::min(2048L, n / (8L * workers)));
+  if (workers == 1 || n <= granularity || !getPool().isWorkerThread()) {
+    for (long i = start; i < end; i++)
+      f(i);
+    return;
+  }
+  parallelForRecursive(start, end, f, granularity);
+}
+
+} // namespace scheduler
+
+#endif // SCHEDULER_H
@@ -38,11 +38,11 @@ inline size_t num_blocks(size_t n, size_t block_size) {
 
 template <class F> void sliced_for(size_t n, size_t block_size, const F &f) {
   size_t l = num_blocks(n, block_size);
-  parallel_for_1(size_t i = 0; i < l; i++) {
+  parallel_for(0, l, [&](size_t i) {
     size_t s = i * block_size;
     size_t e = min(s + block_size, n);
     f(i, s, e);
-  }
+  }, 1);
 }
 
 template <class Index_Map, class F>
@@ -258,7 +258,7 @@ template <class T, class PRED> size_t filterf(T *In, T *Out, size_t n, PRED p) {
   size_t l = nblocks(n, b);
   b = nblocks(n, l);
   size_t *Sums = new_array_no_init<size_t>(l + 1);
-  parallel_for_1(size_t i = 0; i < l; i++) {
+  parallel_for(0, l, [&](size_t i) {
     size_t s = i * b;
     size_t e = min(s + b, n);
     size_t k = s;
@@ -266,17 +266,17 @@ template <class T, class PRED> size_t filterf(T *In, T *Out, size_t n, PRED p) {
       if (p(In[j]))
         In[k++] = In[j];
     Sums[i] = k - s;
-  }
+  }, 1);
   auto isums = array_imap<size_t>(Sums, l);
   size_t m = scan_add(isums, isums);
   Sums[l] = m;
-  parallel_for_1(size_t i = 0; i < l; i++) {
+  parallel_for(0, l, [&](size_t i) {
     T *I = In + i * b;
     T *O = Out + Sums[i];
     for (size_t j = 0; j < Sums[i + 1] - Sums[i]; j++) {
       O[j] = I[j];
     }
-  }
+  }, 1);
   free(Sums);
   return m;
 }
@@ -289,7 +289,7 @@ size_t filterf_and_clear(T *In, T *Out, size_t n, PRED p, T &empty,
     return filter_serial(In, Out, n, p);
   size_t l = nblocks(n, b);
   b = nblocks(n, l);
-  parallel_for_1(size_t i = 0; i < l; i++) {
+  parallel_for(0, l, [&](size_t i) {
     size_t s = i * b;
     size_t e = min(s + b, n);
     size_t k = s;
@@ -303,18 +303,18 @@ size_t filterf_and_clear(T *In, T *Out, size_t n, PRED p, T &empty,
       }
     }
     Sums[i] = k - s;
-  }
+  }, 1);
   auto isums = array_imap<size_t>(Sums, l);
   size_t m = scan_add(isums, isums);
   Sums[l] = m;
-  parallel_for_1(size_t i = 0; i < l; i++) {
+  parallel_for(0, l, [&](size_t i) {
     T *I = In + i * b;
     T *O = Out + Sums[i];
     for (size_t j = 0; j < Sums[i + 1] - Sums[i]; j++) {
       O[j] = I[j];
       I[j] = empty;
     }
-  }
+  }, 1);
   return m;
 }
 
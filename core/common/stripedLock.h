@@ -0,0 +1,83 @@
+// Copyright (c) 2020 Mugilan Mariappan, Joanna Che and Keval Vora.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __STRIPED_LOCK_H__
+#define __STRIPED_LOCK_H__
+
+#include "ligraUtils.h"
+#include <thread>
+
+// A fixed number of spinlocks shared by all the keys (vertices). A key is
+// hashed to one of the stripes, so the memory used does not depend on the
+// number of keys, and an uncontended lock is a single atomic exchange.
+// Two keys can share a stripe, so a thread must not hold more than one lock
+// at a time.
+class StripedLock {
+  // Each stripe takes a cache line, so that threads spinning on different
+  // stripes do not interfere with each other.
+  struct alignas(64) Stripe {
+    volatile int locked;
+  };
+
+  Stripe *stripes;
+  ulong mask;
+
+  inline volatile int *stripe(ulong key) {
+    return &stripes[hashInt(key) & mask].locked;
+  }
+
+public:
+  StripedLock() : stripes(nullptr), mask(0) {}
+
+  // The number of stripes is rounded up to a power of 2
+  void create(long num_stripes) {
+    ulong size = 1;
+    while ((long)size < num_stripes) {
+      size <<= 1;
+    }
+    mask = size - 1;
+    stripes = pbbs::new_array_no_init<Stripe>(size);
+    for (ulong i = 0; i < size; i++) {
+      stripes[i].locked = 0;
+    }
+  }
+
+  void del() { deleteA(stripes); }
+
+  long size() const { return mask + 1; }
+
+  inline void lock(ulong key) {
+    volatile int *locked = stripe(key);
+    while (__sync_lock_test_and_set(locked, 1)) {
+      int spins = 0;
+      while (*locked) {
+        if (++spins == 1024) {
+          spins = 0;
+          std::this_thread::yield();
+        }
+      }
+    }
+  }
+
+  inline void unlock(ulong key) { __sync_lock_release(stripe(key)); }
+};
+
+#endif
@@ -0,0 +1,115 @@
+// Copyright (c) 2020 Mugilan Mariappan, Joanna Che and Keval Vora.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef TEXT_SCANNER_H
+#define TEXT_SCANNER_H
+
+// Helpers for parsing whitespace separated text (adjacency graph files and
+// edge operation streams) in place, without building std::string tokens or
+// word arrays. Every byte <= ' ' (including '\0') is treated as a separator,
+// which makes the separator test a single comparison.
+
+#include "ligraUtils.h"
+#include "parallel.h"
+
+// Size of the chunks scanned by each task in forEachToken.
+#define TEXT_SCANNER_CHUNK_SIZE (1 << 16)
+
+inline bool isSeparator(char c) { return (unsigned char)c <= ' '; }
+
+// Parses the unsigned integer at the start of s. Stops at the first
+// character that is not a digit.
+template <class T> inline T parseUnsigned(const char *s) {
+  T value = 0;
+  unsigned digit;
+  while ((digit = (unsigned char)*s - '0') < 10) {
+    value = value * 10 + digit;
+    s++;
+  }
+  return value;
+}
+
+// Splits s into at most maxTokens tokens, '\0' terminating each of them in
+// place. Returns the total number of tokens in s, which can be larger than
+// maxTokens.
+inline int splitTokens(char *s, char **tokens, int maxTokens) {
+  int count = 0;
+  while (true) {
+    while (*s != 0 && isSeparator(*s))
+      s++;
+    if (*s == 0)
+      return count;
+    if (count < maxTokens)
+      tokens[count] = s;
+    count++;
+    while (!isSeparator(*s))
+      s++;
+    if (*s == 0)
+      return count;
+    *s++ = 0;
+  }
+}
+
+// Replaces every separator in Str[0, n) with '\0', so that each token is a
+// '\0' terminated string.
+inline void terminateTokens(char *Str, long n) {
+  parallel_for(0, n, [&](long i) {
+    if (isSeparator(Str[i]))
+      Str[i] = 0;
+  });
+}
+
+// Calls f(index, token) for every token of Str[0, n), where index is the
+// position of the token in Str. Str must have been processed with
+// terminateTokens(). The buffer is cut into fixed size chunks: a first pass
+// counts the tokens starting in each chunk, and a second pass hands every
+// token to f along with its global index, so that f can write the parsed
+// value straight into its destination array. Returns the number of tokens.
+template <class F> long forEachToken(char *Str, long n, F f) {
+  if (n <= 0)
+    return 0;
+  long numChunks = nblocks(n, (long)TEXT_SCANNER_CHUNK_SIZE);
+  long *tokenOffsets = newA(long, numChunks);
+  parallel_for(0, numChunks, [&](long c) {
+    long start = c * TEXT_SCANNER_CHUNK_SIZE;
+    long end = min(n, start + TEXT_SCANNER_CHUNK_SIZE);
+    long count = (start == 0 && Str[0] != 0);
+    for (long i = max(start, 1L); i < end; i++)
+      count += (Str[i] != 0) & (Str[i - 1] == 0);
+    tokenOffsets[c] = count;
+  }, 1);
+  long numTokens = sequence::plusScan(tokenOffsets, tokenOffsets, numChunks);
+  parallel_for(0, numChunks, [&](long c) {
+    long start = c * TEXT_SCANNER_CHUNK_SIZE;
+    long end = min(n, start + TEXT_SCANNER_CHUNK_SIZE);
+    long index = tokenOffsets[c];
+    if (start == 0 && Str[0] != 0)
+      f(index++, Str);
+    for (long i = max(start, 1L); i < end; i++) {
+      if (Str[i] != 0 && Str[i - 1] == 0)
+        f(index++, Str + i);
+    }
+  }, 1);
+  free(tokenOffsets);
+  return numTokens;
+}
+
+#endif
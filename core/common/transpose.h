@@ -41,15 +41,15 @@ template <class E, class intV> struct transpose {
     } else if (cCount > rCount) {
       intV l1 = cCount / 2;
       intV l2 = cCount - cCount / 2;
-      cilk_spawn this->transR(rStart, rCount, rLength, cStart, l1, cLength);
-      transR(rStart, rCount, rLength, cStart + l1, l2, cLength);
-      cilk_sync;
+      par_do(
+          [&]() { transR(rStart, rCount, rLength, cStart, l1, cLength); },
+          [&]() { transR(rStart, rCount, rLength, cStart + l1, l2, cLength); });
     } else {
       intV l1 = rCount / 2;
       intV l2 = rCount - rCount / 2;
-      cilk_spawn this->transR(rStart, l1, rLength, cStart, cCount, cLength);
-      transR(rStart + l1, l2, rLength, cStart, cCount, cLength);
-      cilk_sync;
+      par_do(
+          [&]() { transR(rStart, l1, rLength, cStart, cCount, cLength); },
+          [&]() { transR(rStart + l1, l2, rLength, cStart, cCount, cLength); });
     }
   }
 
@@ -81,15 +81,15 @@ template <class E, class intV> struct blockTrans {
     } else if (cCount > rCount) {
       intV l1 = cCount / 2;
       intV l2 = cCount - cCount / 2;
-      cilk_spawn this->transR(rStart, rCount, rLength, cStart, l1, cLength);
-      transR(rStart, rCount, rLength, cStart + l1, l2, cLength);
-      cilk_sync;
+      par_do(
+          [&]() { transR(rStart, rCount, rLength, cStart, l1, cLength); },
+          [&]() { transR(rStart, rCount, rLength, cStart + l1, l2, cLength); });
     } else {
       intV l1 = rCount / 2;
       intV l2 = rCount - rCount / 2;
-      cilk_spawn this->transR(rStart, l1, rLength, cStart, cCount, cLength);
-      transR(rStart + l1, l2, rLength, cStart, cCount, cLength);
-      cilk_sync;
+      par_do(
+          [&]() { transR(rStart, l1, rLength, cStart, cCount, cLength); },
+          [&]() { transR(rStart + l1, l2, rLength, cStart, cCount, cLength); });
     }
   }
 
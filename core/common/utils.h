@@ -31,6 +31,7 @@
 #include "ligraUtils.h"
 #include "parallel.h"
 #include "rwlock.h"
+#include "stripedLock.h"
 #include <vector>
 using namespace std;
 
@@ -38,9 +39,6 @@ using namespace std;
 // #define ENABLE_CHECK_SOURCE
 #define CHECK_DEBUG_STATE(x) 1
 #define ENABLE_PARTITION 1
-#ifdef INCLUDEEXTRABUFFERSPACE
-#define EDGE_ARRAY_BUFFER 10
-#endif
 #define USE_PARALLEL_SCAN
 
 #ifndef DEBUG_UTIL_H
@@ -48,13 +48,13 @@ template <class F, class VS,
 void vertexMap(VS &V, F f) {
   size_t n = V.numRows(), m = V.numNonzeros();
   if (V.dense()) {
-    parallel_for(long i = 0; i < n; i++) {
+    parallel_for(0, n, [&](long i) {
       if (V.isIn(i)) {
         f(i, V.ithData(i));
       }
-    }
+    });
   } else {
-    parallel_for(long i = 0; i < m; i++) { f(V.vtx(i), V.vtxData(i)); }
+    parallel_for(0, m, [&](long i) { f(V.vtx(i), V.vtxData(i)); });
   }
 }
 
@@ -64,13 +64,13 @@ template <class VS, class F,
 void vertexMap(VS &V, F f) {
   size_t n = V.numRows(), m = V.numNonzeros();
   if (V.dense()) {
-    parallel_for(long i = 0; i < n; i++) {
+    parallel_for(0, n, [&](long i) {
       if (V.isIn(i)) {
         f(i);
       }
-    }
+    });
   } else {
-    parallel_for(long i = 0; i < m; i++) { f(V.vtx(i)); }
+    parallel_for(0, m, [&](long i) { f(V.vtx(i)); });
   }
 }
 
@@ -80,8 +80,13 @@ template <class F> vertexSubset vertexFilter(vertexSubset &V, F filter) {
   long n = V.numRows(), m = V.numNonzeros();
   V.toDense();
   bool *d_out = newA(bool, n);
-  { parallel_for(long i = 0; i < n; i++) d_out[i] = 0; }
-  { parallel_for(long i = 0; i < n; i++) if (V.d[i]) d_out[i] = filter(i); }
+  { parallel_for(0, n, [&](long i) { d_out[i] = 0; }); }
+  {
+    parallel_for(0, n, [&](long i) {
+      if (V.d[i])
+        d_out[i] = filter(i);
+    });
+  }
   // {for(long i=0;i<n;i++)
   //     if(V.d[i]) d_out[i] = filter(i);}
   return vertexSubset(n, d_out);
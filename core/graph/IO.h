@@ -28,7 +28,10 @@
 #ifndef __IO_H__
 #define __IO_H__
 
+#include "../common/textScanner.h"
 #include "graph.h"
+#include "graphSnapshot.h"
+#include <fcntl.h>
 #include <iostream>
 #include <stdio.h>
 #include <stdlib.h>
@@ -121,6 +124,7 @@ _seq<char> readStringFromFile(char *fileName) {
   cout << "readStringFromFile: " << n << endl;
   char *bytes = newA(char, n + 1);
   file.read(bytes, n);
+  bytes[n] = 0;
   file.close();
   return _seq<char>(bytes, n);
 }
@@ -130,15 +134,17 @@ words stringToWords(char *Str, unsigned long n) {
   cout << "n : " << n << endl;
 
   {
-    parallel_for(unsigned long i = 0; i < n; i++) if (isSpace(Str[i])) Str[i] =
-        0;
+    parallel_for(0, n, [&](unsigned long i) {
+      if (isSpace(Str[i]))
+        Str[i] = 0;
+    });
   }
 
   // mark start of words
   bool *FL = newA(bool, n);
   FL[0] = Str[0];
   {
-    parallel_for(unsigned long i = 1; i < n; i++) FL[i] = Str[i] && !Str[i - 1];
+    parallel_for(1, n, [&](unsigned long i) { FL[i] = Str[i] && !Str[i - 1]; });
   }
 
   // offset for each start of word
@@ -151,7 +157,7 @@ words stringToWords(char *Str, unsigned long n) {
 
   // pointer to each start of word
   char **SA = newA(char *, m);
-  { parallel_for(unsigned long j = 0; j < m; j++) SA[j] = Str + offsets[j]; }
+  { parallel_for(0, m, [&](unsigned long j) { SA[j] = Str + offsets[j]; }); }
 
   free(offsets);
   free(FL);
@@ -161,12 +167,10 @@ words stringToWords(char *Str, unsigned long n) {
 uintE removeDuplicates(intPair *&array, uintE length, bool symmetric,
                        bool debugFlag) {
   bool *flag = newAWithZero(bool, length);
-  uintE invalidCount = 0;
-  parallel_for(uintE i = 1; i < length; i++) {
+  parallel_for(1, length, [&](uintE i) {
     if (array[i].first == array[i - 1].first &&
         array[i].second == array[i - 1].second) {
       flag[i] = true;
-      invalidCount++;
       if (debugFlag) {
         cerr << "INVALID: " << array[i].first << "\t" << array[i].second
              << "\n";
@@ -175,26 +179,19 @@ uintE removeDuplicates(intPair *&array, uintE length, bool symmetric,
     if (symmetric && (array[i].first == array[i - 1].second) &&
         (array[i].second == array[i - 1].first)) {
       flag[i] = true;
-      invalidCount++;
       if (debugFlag) {
         cerr << "INVALID: " << array[i].first << "\t" << array[i].second
              << "\n";
       }
     }
-  }
+  });
 
-  uintE count = 0;
-  // intPair* temp = newA(intPair, length - invalidCount);
-  intPair *temp = newA(intPair, (length - invalidCount));
-  for (uintE i = 0; i < length; i++) {
-    if (!flag[i]) {
-      temp[count].first = array[i].first;
-      temp[count].second = array[i].second;
-      count++;
-    }
-  }
+  // keep the edges that are not flagged
+  parallel_for(0, length, [&](uintE i) { flag[i] = !flag[i]; });
+  intPair *temp = newA(intPair, length);
+  uintE count = sequence::pack(array, temp, flag, (long)length);
+  uintE invalidCount = length - count;
 
-  // intPair *x = array;
   free(array);
   array = temp;
   // free(array);
@@ -211,12 +208,10 @@ uintE removeDuplicates(intPair *&array, uintE length, bool symmetric,
 uintE removeDuplicates(intWeights *&array, uintE length, bool symmetric,
                        bool debugFlag) {
   bool *flag = newAWithZero(bool, length);
-  uintE invalidCount = 0;
-  parallel_for(uintE i = 1; i < length; i++) {
+  parallel_for(1, length, [&](uintE i) {
     if (array[i].first == array[i - 1].first &&
         array[i].second.first == array[i - 1].second.first) {
       flag[i] = true;
-      invalidCount++;
       if (debugFlag) {
         cerr << "INVALID: " << array[i].first << "\t" << array[i].second.first
              << "\n";
@@ -225,25 +220,18 @@ uintE removeDuplicates(intWeights *&array, uintE length, bool symmetric,
     if (symmetric && (array[i].first == array[i - 1].second.first) &&
         (array[i].second.first == array[i - 1].first)) {
       flag[i] = true;
-      invalidCount++;
       if (debugFlag) {
         cerr << "INVALID: " << array[i].first << "\t" << array[i].second.first
              << "\n";
       }
     }
-  }
+  });
 
-  uintE count = 0;
+  // keep the edges that are not flagged
+  parallel_for(0, length, [&](uintE i) { flag[i] = !flag[i]; });
   intWeights *temp = newA(intWeights, length);
-  for (uintE i = 0; i < length; i++) {
-    if (!flag[i]) {
-      temp[count].first = array[i].first;
-      temp[count].second.first = array[i].second.first;
-      temp[count].second.second = array[i].second.second;
-
-      count++;
-    }
-  }
+  uintE count = sequence::pack(array, temp, flag, (long)length);
+  uintE invalidCount = length - count;
 
   free(array);
   array = temp;
@@ -260,12 +248,10 @@ uintE removeDuplicates(intWeights *&array, uintE length, bool symmetric,
 uintE removeDuplicates(edge *&array, uintE length, uintE maxLength,
                        bool symmetric, bool debugFlag) {
   bool *flag = newAWithZero(bool, length);
-  uintE invalidCount = 0;
-  parallel_for(uintE i = 1; i < length; i++) {
+  parallel_for(1, length, [&](uintE i) {
     if (array[i].source == array[i - 1].source &&
         array[i].destination == array[i - 1].destination) {
       flag[i] = true;
-      invalidCount++;
       if (debugFlag) {
         cerr << "INVALID: " << array[i].source << "\t" << array[i].destination
              << "\n";
@@ -274,32 +260,25 @@ uintE removeDuplicates(edge *&array, uintE length, uintE maxLength,
     if (symmetric && (array[i].source == array[i - 1].destination) &&
         (array[i].destination == array[i - 1].source)) {
       flag[i] = true;
-      invalidCount++;
       if (debugFlag) {
         cerr << "INVALID: " << array[i].source << "\t" << array[i].destination
              << "\n";
       }
     }
-  }
+  });
 
-  uintE count = 0;
-  // edge* temp = newA(edge, length - invalidCount);
-  edge *temp = newA(edge, maxLength);
-  for (uintE i = 0; i < length; i++) {
-    if (!flag[i]) {
-      temp[count].source = array[i].source;
-      temp[count].destination = array[i].destination;
+  // keep the edges that are not flagged
+  parallel_for(0, length, [&](uintE i) {
+    flag[i] = !flag[i];
 #ifdef EDGEDATA
-      temp[count].edgeData = array[i].edgeData;
-#endif
-      count++;
-    }
-#ifdef EDGEDATA
-    else {
+    if (!flag[i]) {
       array[i].edgeData->del();
     }
 #endif
-  }
+  });
+  edge *temp = newA(edge, maxLength);
+  uintE count = sequence::pack(array, temp, flag, (long)length);
+  uintE invalidCount = length - count;
 
   free(array);
   array = temp;
@@ -312,64 +291,80 @@ uintE removeDuplicates(edge *&array, uintE length, uintE maxLength,
   return count;
 }
 
+#ifdef EDGEDATA
+inline void deleteEdgeDataArray(EdgeData *edgeData, unsigned long m) {
+  parallel_for(0, m, [&](unsigned long i) { edgeData[i].del(); });
+  free(edgeData);
+}
+#endif
+
 template <class vertex>
 graph<vertex> readGraphFromFile(char *fname, bool isSymmetric, bool simpleFlag,
                                 bool debugFlag) {
-  words W;
   _seq<char> S = readStringFromFile(fname);
-  W = stringToWords(S.A, S.n);
+  char *Str = S.A;
+  terminateTokens(Str, S.n);
+
+  // Header: graph type, n and m
+  char *header[3];
+  char *p = Str;
+  char *end = Str + S.n;
+  for (int i = 0; i < 3; i++) {
+    while (p < end && *p == 0)
+      p++;
+    header[i] = p;
+    while (p < end && *p != 0)
+      p++;
+  }
 #ifdef EDGEDATA
-  if (W.Strings[0] != (string) "WeightedAdjacencyGraph") {
+  if (header[0] != (string) "WeightedAdjacencyGraph") {
 #else
-  if (W.Strings[0] != (string) "AdjacencyGraph") {
+  if (header[0] != (string) "AdjacencyGraph") {
 #endif
     cout << "Bad input file" << endl;
     abort();
   }
 
-  unsigned long len = W.m - 1;
-  unsigned long n = atol(W.Strings[1]);
-  unsigned long m = atol(W.Strings[2]);
-  unsigned long edgeDataSize = atol(
-      W.Strings[3]); // this really doesn't matter (should we even keep it?)
-
-  cout << W.Strings[44] << endl;
+  unsigned long n = parseUnsigned<unsigned long>(header[1]);
+  unsigned long m = parseUnsigned<unsigned long>(header[2]);
 
   cout << "n : " << n << endl;
   cout << "m : " << m << endl;
-  cout << "len : " << len << endl;
-#ifdef EDGEDATA
-  if (len != n + 2 * m + 2) {
-#else
-  if (len != n + m + 2) {
-#endif
-    cout << "Length : " << len << endl;
-    cout << "Bad input file" << endl;
-    abort();
-  }
 
   intE *offsets = newA(intE, n);
   uintV *edges = newA(uintV, m);
 #ifdef EDGEDATA
   EdgeData *edgeData = newA(EdgeData, m);
+  unsigned long expectedTokens = n + 2 * m;
+#else
+  unsigned long expectedTokens = n + m;
 #endif
-  {
-    parallel_for(unsigned long i = 0; i < n; i++) offsets[i] =
-        atol(W.Strings[i + 3]);
-  }
-  {
-    parallel_for(unsigned long i = 0; i < m; i++) {
-      edges[i] = atol(W.Strings[i + n + 3]);
+  // Offsets, edges and edge data are parsed straight from the file buffer
+  // into their arrays.
+  unsigned long len =
+      forEachToken(p, end - p, [&](unsigned long i, char *token) {
+        if (i < n) {
+          offsets[i] = parseUnsigned<intE>(token);
+        } else if (i < n + m) {
+          edges[i - n] = parseUnsigned<uintV>(token);
+        }
 #ifdef EDGEDATA
-      new (edgeData + i) EdgeData();
-      edgeData[i].createEdgeData(W.Strings[i + n + m + 3]);
+        else if (i < n + 2 * m) {
+          new (edgeData + (i - n - m)) EdgeData();
+          edgeData[i - n - m].createEdgeData(token);
+        }
 #endif
-    }
+      });
+  cout << "len : " << len + 2 << endl;
+  if (len != expectedTokens) {
+    cout << "Length : " << len + 2 << endl;
+    cout << "Bad input file" << endl;
+    abort();
   }
-  W.del(); // to deal with performance bug in malloc
+  S.del(); // to deal with performance bug in malloc
   vertex *v = newA(vertex, n);
   {
-    parallel_for(uintV i = 0; i < n; i++) {
+    parallel_for(0, n, [&](uintV i) {
       intE o = offsets[i];
       intE l = ((i == n - 1) ? m : offsets[i + 1]) - offsets[i];
       v[i].setOutDegree(l);
@@ -377,7 +372,7 @@ graph<vertex> readGraphFromFile(char *fname, bool isSymmetric, bool simpleFlag,
 #ifdef EDGEDATA
       v[i].setOutEdgeDataArray(edgeData + o);
 #endif
-    }
+    });
   }
 
   intE *tOffsets;
@@ -385,14 +380,14 @@ graph<vertex> readGraphFromFile(char *fname, bool isSymmetric, bool simpleFlag,
   // TODO: ADD SYMMETRIC SUPPORT
   if (!isSymmetric) {
     tOffsets = newA(intE, n);
-    { parallel_for(unsigned long i = 0; i < n; i++) tOffsets[i] = INT_E_MAX; }
+    { parallel_for(0, n, [&](unsigned long i) { tOffsets[i] = INT_E_MAX; }); }
 #ifdef EDGEDATA
     intWeights *temp = newA(intWeights, m);
 #else
     intPair *temp = newA(intPair, m);
 #endif
     {
-      parallel_for(unsigned long i = 0; i < n; i++) {
+      parallel_for(0, n, [&](unsigned long i) {
         intE o = offsets[i];
         for (intE j = 0; j < v[i].getOutDegree(); j++) {
 #ifdef EDGEDATA
@@ -402,7 +397,7 @@ graph<vertex> readGraphFromFile(char *fname, bool isSymmetric, bool simpleFlag,
           temp[o + j] = make_pair(v[i].getOutNeighbor(j), i);
 #endif
         }
-      }
+      });
     }
     // free(offsets);
 #ifdef EDGEDATA
@@ -425,7 +420,7 @@ graph<vertex> readGraphFromFile(char *fname, bool isSymmetric, bool simpleFlag,
     inEdges[0] = temp[0].second;
 #endif
     {
-      parallel_for(unsigned long i = 1; i < m; i++) {
+      parallel_for(1, m, [&](unsigned long i) {
 #ifdef EDGEDATA
         inEdges[i] = temp[i].second.first;
         new (inEdgeData + i) EdgeData();
@@ -436,7 +431,7 @@ graph<vertex> readGraphFromFile(char *fname, bool isSymmetric, bool simpleFlag,
         if (temp[i].first != temp[i - 1].first) {
           tOffsets[temp[i].first] = i;
         }
-      }
+      });
     }
 
     free(temp);
@@ -446,7 +441,7 @@ graph<vertex> readGraphFromFile(char *fname, bool isSymmetric, bool simpleFlag,
     sequence::scanIBack(tOffsets, tOffsets, n, minF<intE>(), (intE)m);
 
     {
-      parallel_for(unsigned long i = 0; i < n; i++) {
+      parallel_for(0, n, [&](unsigned long i) {
         uintE o = tOffsets[i];
         uintE l = ((i == n - 1) ? m : tOffsets[i + 1]) - tOffsets[i];
         v[i].setInDegree(l);
@@ -454,32 +449,305 @@ graph<vertex> readGraphFromFile(char *fname, bool isSymmetric, bool simpleFlag,
 #ifdef EDGEDATA
         v[i].setInEdgeDataArray(inEdgeData + o);
 #endif
-      }
+      });
     }
 
 #ifdef EDGEDATA
     AdjacencyRep<vertex> *mem = new AdjacencyRep<vertex>(
         v, n, m, edges, inEdges, offsets, tOffsets, edgeData, inEdgeData);
+    deleteEdgeDataArray(inEdgeData, m);
 #else
     AdjacencyRep<vertex> *mem =
         new AdjacencyRep<vertex>(v, n, m, edges, inEdges, offsets, tOffsets);
+#endif
+    free(inEdges);
+    free(tOffsets);
+    free(edges);
+    free(offsets);
+#ifdef EDGEDATA
+    deleteEdgeDataArray(edgeData, m);
 #endif
     return graph<vertex>(v, n, m, mem);
   } else {
 #ifdef EDGEDATA
     AdjacencyRep<vertex> *mem = new AdjacencyRep<vertex>(
         v, n, m, edges, NULL, offsets, NULL, edgeData, NULL);
+    deleteEdgeDataArray(edgeData, m);
 #else
     AdjacencyRep<vertex> *mem =
         new AdjacencyRep<vertex>(v, n, m, edges, NULL, offsets, NULL);
 #endif
+    free(edges);
+    free(offsets);
     return graph<vertex>(v, n, m, mem);
   }
 }
 
+// Returns the vertex ids of a snapshot section as uintV. The mapped section
+// is used directly when its vertex width matches uintV, otherwise the ids are
+// copied into a new array and copied is set.
+inline uintV *snapshotVertexIds(char *section, unsigned long count,
+                                uint32_t vertexWidth, bool &copied) {
+  copied = (vertexWidth != sizeof(uintV));
+  if (!copied) {
+    return (uintV *)section;
+  }
+  uintV *ids = newA(uintV, count);
+  if (vertexWidth == 4) {
+    parallel_for(0, count, [&](unsigned long i) {
+      ids[i] = ((uint32_t *)section)[i];
+    });
+  } else {
+    parallel_for(0, count, [&](unsigned long i) {
+      ids[i] = ((uint64_t *)section)[i];
+    });
+  }
+  return ids;
+}
+
+// Loads a graph written by tools/converters/AdjToSnapshotConverter. The file
+// is memory-mapped, so there is no text to parse and no transpose to build:
+// the vertices are copied straight from the mapped CSR arrays.
+template <class vertex>
+graph<vertex> readGraphFromSnapshot(char *fname, bool isSymmetric,
+                                    bool simpleFlag, bool debugFlag) {
+  int fd = open(fname, O_RDONLY);
+  struct stat sb;
+  if (fd == -1 || fstat(fd, &sb) == -1) {
+    cout << "Unable to open file: " << fname << endl;
+    abort();
+  }
+  char *data = (char *)mmap(0, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    cout << "Unable to mmap file: " << fname << endl;
+    abort();
+  }
+  madvise(data, sb.st_size, MADV_WILLNEED);
+
+  GraphSnapshotHeader header;
+  memcpy(&header, data, sizeof(GraphSnapshotHeader));
+  GraphSnapshotHeader expected = header;
+  if ((unsigned long)sb.st_size < sizeof(GraphSnapshotHeader) ||
+      !header.isValid() ||
+      expected.layout(header.hasInEdges()) > (uint64_t)sb.st_size) {
+    cout << "Bad snapshot file" << endl;
+    abort();
+  }
+#ifdef EDGEDATA
+  if (header.edge_data_width != sizeof(EdgeData)) {
+    cout << "Snapshot does not contain edge data of this application ("
+         << header.edge_data_width << " bytes per edge, expected "
+         << sizeof(EdgeData) << ")" << endl;
+    abort();
+  }
+#endif
+  if (!isSymmetric && !header.hasInEdges()) {
+    cout << "Snapshot does not contain in-edges. Convert it without \"-s\" "
+            "to use it as a directed graph"
+         << endl;
+    abort();
+  }
+  if (simpleFlag) {
+    cout << "WARNING: Duplicate edges are not removed from snapshots" << endl;
+  }
+
+  unsigned long n = header.n;
+  unsigned long m = header.m;
+  cout << "n : " << n << endl;
+  cout << "m : " << m << endl;
+
+  uint64_t *outOffsets = (uint64_t *)(data + header.out_offsets_pos);
+  intE *offsets = newA(intE, n);
+  vertex *v = newA(vertex, n);
+  parallel_for(0, n, [&](uintV i) {
+    offsets[i] = outOffsets[i];
+    v[i].setOutDegree(outOffsets[i + 1] - outOffsets[i]);
+  });
+  bool edgesCopied;
+  uintV *edges = snapshotVertexIds(data + header.out_edges_pos, m,
+                                   header.vertex_width, edgesCopied);
+#ifdef EDGEDATA
+  // Edge data is stored as raw EdgeData values, used from the mapping
+  EdgeData *edgeData = (EdgeData *)(data + header.out_edge_data_pos);
+#endif
+
+  AdjacencyRep<vertex> *mem;
+  if (!isSymmetric) {
+    uint64_t *inOffsets = (uint64_t *)(data + header.in_offsets_pos);
+    intE *tOffsets = newA(intE, n);
+    parallel_for(0, n, [&](uintV i) {
+      tOffsets[i] = inOffsets[i];
+      v[i].setInDegree(inOffsets[i + 1] - inOffsets[i]);
+    });
+    bool inEdgesCopied;
+    uintV *inEdges = snapshotVertexIds(data + header.in_edges_pos, m,
+                                       header.vertex_width, inEdgesCopied);
+#ifdef EDGEDATA
+    EdgeData *inEdgeData = (EdgeData *)(data + header.in_edge_data_pos);
+    mem = new AdjacencyRep<vertex>(v, n, m, edges, inEdges, offsets, tOffsets,
+                                   edgeData, inEdgeData);
+#else
+    mem = new AdjacencyRep<vertex>(v, n, m, edges, inEdges, offsets, tOffsets);
+#endif
+    if (inEdgesCopied)
+      free(inEdges);
+    free(tOffsets);
+  } else {
+#ifdef EDGEDATA
+    mem = new AdjacencyRep<vertex>(v, n, m, edges, NULL, offsets, NULL,
+                                   edgeData, NULL);
+#else
+    mem = new AdjacencyRep<vertex>(v, n, m, edges, NULL, offsets, NULL);
+#endif
+  }
+  if (edgesCopied)
+    free(edges);
+  free(offsets);
+  munmap(data, sb.st_size);
+  close(fd);
+  return graph<vertex>(v, n, m, mem);
+}
+
+// Number of entries staged in memory at a time by writeGraphSnapshot.
+#define SNAPSHOT_WRITE_BUFFER_ENTRIES (1 << 22)
+
+// Writes one per-edge section of a snapshot starting at the current position
+// of f. get(i, j) returns the entry of the j-th edge of vertex i. The entries
+// are gathered in parallel into buffer, which holds bufferSize entries, and
+// written out one buffer at a time. Returns false on a write error.
+template <class T, class F>
+bool writeSnapshotEdgeSection(FILE *f, uint64_t *offsets, unsigned long n,
+                              T *buffer, uint64_t bufferSize, F get) {
+  unsigned long lo = 0;
+  while (lo < n) {
+    uint64_t start = offsets[lo];
+    // Largest hi such that the edges of [lo, hi) fit in the buffer.
+    unsigned long hi =
+        upper_bound(offsets + lo + 1, offsets + n + 1, start + bufferSize) -
+        offsets - 1;
+    if (hi == lo) {
+      // The edges of vertex lo alone do not fit; write them in pieces.
+      uint64_t degree = offsets[lo + 1] - start;
+      for (uint64_t first = 0; first < degree; first += bufferSize) {
+        uint64_t count = min(bufferSize, degree - first);
+        parallel_for(0, count,
+                     [&](uint64_t j) { buffer[j] = get(lo, first + j); });
+        if (fwrite(buffer, sizeof(T), count, f) != count)
+          return false;
+      }
+      hi = lo + 1;
+    } else {
+      parallel_for(lo, hi, [&](uintV i) {
+        T *out = buffer + (offsets[i] - start);
+        for (uint64_t j = 0; j < offsets[i + 1] - offsets[i]; j++)
+          out[j] = get(i, j);
+      });
+      uint64_t count = offsets[hi] - start;
+      if (fwrite(buffer, sizeof(T), count, f) != count)
+        return false;
+    }
+    lo = hi;
+  }
+  return true;
+}
+
+// Writes the current version of the graph as a snapshot that readGraph() can
+// load. In-edges are left out for symmetric graphs. Each section is streamed
+// to the file through a bounded buffer, so only the offsets are held in memory
+// in full. The file is synced to the disk before returning. Returns false if
+// the file could not be written.
+template <class vertex>
+bool writeGraphSnapshot(graph<vertex> &G, const char *fname,
+                        uint32_t generation = 0) {
+  unsigned long n = G.n;
+  bool inEdges = !G.isSymmetric();
+  vertex *V = G.V;
+  uint64_t *outOffsets = newA(uint64_t, n + 1);
+  uint64_t *inOffsets = inEdges ? newA(uint64_t, n + 1) : NULL;
+  parallel_for(0, n, [&](uintV i) {
+    outOffsets[i] = V[i].getOutDegree();
+    if (inEdges)
+      inOffsets[i] = V[i].getInDegree();
+  });
+  outOffsets[n] = 0;
+  uint64_t m = sequence::plusScan(outOffsets, outOffsets, n + 1);
+  if (inEdges)
+    sequence::plusScan(inOffsets, inOffsets, n + 1);
+
+  GraphSnapshotHeader header;
+  memcpy(header.magic, GRAPH_SNAPSHOT_MAGIC, GRAPH_SNAPSHOT_MAGIC_SIZE);
+  header.version = GRAPH_SNAPSHOT_VERSION;
+  header.vertex_width = sizeof(uintV);
+  header.n = n;
+  header.m = m;
+  header.generation = generation;
+#ifdef EDGEDATA
+  header.edge_data_width = sizeof(EdgeData);
+#endif
+  uint64_t fileSize = header.layout(inEdges);
+
+  uint64_t bufferSize = min((uint64_t)SNAPSHOT_WRITE_BUFFER_ENTRIES, m + 1);
+  uintV *edgeBuffer = newA(uintV, bufferSize);
+#ifdef EDGEDATA
+  EdgeData *edgeDataBuffer = newA(EdgeData, bufferSize);
+#endif
+
+  FILE *f = fopen(fname, "wb");
+  bool success = (f != NULL);
+  // Moves to the start of a section once everything before it was written.
+  // The gaps left for alignment read back as zeros.
+  auto seek = [&](uint64_t pos) {
+    return success && fseeko(f, pos, SEEK_SET) == 0;
+  };
+  success = seek(0) &&
+            fwrite(&header, sizeof(GraphSnapshotHeader), 1, f) == 1;
+  success = seek(header.out_offsets_pos) &&
+            fwrite(outOffsets, sizeof(uint64_t), n + 1, f) == n + 1;
+  success = seek(header.out_edges_pos) &&
+            writeSnapshotEdgeSection(
+                f, outOffsets, n, edgeBuffer, bufferSize,
+                [&](uintV i, uint64_t j) { return V[i].getOutNeighbor(j); });
+#ifdef EDGEDATA
+  success = seek(header.out_edge_data_pos) &&
+            writeSnapshotEdgeSection(
+                f, outOffsets, n, edgeDataBuffer, bufferSize,
+                [&](uintV i, uint64_t j) { return *V[i].getOutEdgeData(j); });
+#endif
+  if (inEdges) {
+    success = seek(header.in_offsets_pos) &&
+              fwrite(inOffsets, sizeof(uint64_t), n + 1, f) == n + 1;
+    success = seek(header.in_edges_pos) &&
+              writeSnapshotEdgeSection(
+                  f, inOffsets, n, edgeBuffer, bufferSize,
+                  [&](uintV i, uint64_t j) { return V[i].getInNeighbor(j); });
+#ifdef EDGEDATA
+    success = seek(header.in_edge_data_pos) &&
+              writeSnapshotEdgeSection(
+                  f, inOffsets, n, edgeDataBuffer, bufferSize,
+                  [&](uintV i, uint64_t j) { return *V[i].getInEdgeData(j); });
+#endif
+  }
+  success = success && (fflush(f) == 0) &&
+            (ftruncate(fileno(f), fileSize) == 0) && (fsync(fileno(f)) == 0);
+  if (f != NULL)
+    success = (fclose(f) == 0) && success;
+  free(edgeBuffer);
+#ifdef EDGEDATA
+  free(edgeDataBuffer);
+#endif
+  free(outOffsets);
+  if (inEdges)
+    free(inOffsets);
+  return success;
+}
+
 template <class vertex>
 graph<vertex> readGraph(char *iFile, bool symmetric, bool isSimple,
                         bool debugFlag) {
+  if (isGraphSnapshot(iFile)) {
+    return readGraphFromSnapshot<vertex>(iFile, symmetric, isSimple,
+                                         debugFlag);
+  }
   return readGraphFromFile<vertex>(iFile, symmetric, isSimple, debugFlag);
 }
 #endif
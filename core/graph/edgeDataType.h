@@ -23,17 +23,31 @@
 #define EDGEDATATYPE_H
 
 #include "../common/utils.h"
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <stdlib.h>
+#include <type_traits>
 #include <vector>
 
-struct EdgeDataType {
-public:
-  virtual void createEdgeData(const char *edgeDataString) = 0;
-  virtual void setEdgeDataFromPtr(EdgeDataType *edgeData) = 0;
-  virtual void del() = 0;
-  virtual ~EdgeDataType() = default;
+// Base of the edge data types, resolved at compile time: T derives from
+// EdgeDataType<T> and provides
+//   void createEdgeData(const char *edgeDataString);
+// Edge data is stored by value in arrays parallel to the adjacency arrays,
+// which are moved with memcpy when they grow, so T must be trivially
+// copyable and may not own memory. The base holds no data and no vtable, so
+// sizeof(T) is the size of its payload.
+template <class T> struct EdgeDataType {
+  void setEdgeDataFromPtr(const T *edgeData) {
+    *static_cast<T *>(this) = *edgeData;
+  }
+
+  void del() {}
+};
+
+template <class T> struct isEdgeDataType {
+  static const bool value = std::is_base_of<EdgeDataType<T>, T>::value &&
+                            std::is_trivially_copyable<T>::value;
 };
 
 #endif
@@ -0,0 +1,123 @@
+// Copyright (c) 2020 Mugilan Mariappan, Joanna Che and Keval Vora.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef EDGE_STREAM_FORMAT_H
+#define EDGE_STREAM_FORMAT_H
+
+// Binary edge operation stream. The stream starts with an EdgeStreamHeader
+// followed by fixed width records:
+//
+//   [edge type : 1 byte ('a' or 'd')]
+//   [source : vertex_width bytes]
+//   [destination : vertex_width bytes]
+//   [edge data : edge_data_width bytes]
+//
+// Vertex ids are unsigned integers in host byte order. The edge data field
+// holds the raw EdgeData value of the application (see edgeDataType.h), so
+// edge_data_width is sizeof(EdgeData).
+
+#include <cstdint>
+#include <cstring>
+
+#define EDGE_STREAM_MAGIC "GBES"
+#define EDGE_STREAM_MAGIC_SIZE 4
+#define EDGE_STREAM_VERSION 2
+
+struct EdgeStreamHeader {
+  char magic[EDGE_STREAM_MAGIC_SIZE];
+  uint32_t version;
+  uint32_t vertex_width;    // 4 or 8
+  uint32_t edge_data_width; // 0 if the records do not carry edge data
+
+  EdgeStreamHeader() : version(0), vertex_width(0), edge_data_width(0) {
+    memset(magic, 0, EDGE_STREAM_MAGIC_SIZE);
+  }
+
+  EdgeStreamHeader(uint32_t _vertex_width, uint32_t _edge_data_width)
+      : version(EDGE_STREAM_VERSION), vertex_width(_vertex_width),
+        edge_data_width(_edge_data_width) {
+    memcpy(magic, EDGE_STREAM_MAGIC, EDGE_STREAM_MAGIC_SIZE);
+  }
+
+  bool isValid() const {
+    return memcmp(magic, EDGE_STREAM_MAGIC, EDGE_STREAM_MAGIC_SIZE) == 0 &&
+           version == EDGE_STREAM_VERSION &&
+           (vertex_width == 4 || vertex_width == 8);
+  }
+
+  size_t recordSize() const { return 1 + 2 * vertex_width + edge_data_width; }
+};
+
+inline uint64_t readStreamVertex(const char *src, uint32_t vertex_width) {
+  if (vertex_width == 4) {
+    uint32_t v;
+    memcpy(&v, src, 4);
+    return v;
+  }
+  uint64_t v;
+  memcpy(&v, src, 8);
+  return v;
+}
+
+inline void writeStreamVertex(char *dst, uint64_t v, uint32_t vertex_width) {
+  if (vertex_width == 4) {
+    uint32_t v32 = (uint32_t)v;
+    memcpy(dst, &v32, 4);
+  } else {
+    memcpy(dst, &v, 8);
+  }
+}
+
+// Decodes the record at 'record'. edgeData points to the edge data field of
+// the record, which is not aligned.
+inline void decodeEdgeStreamRecord(const char *record,
+                                   const EdgeStreamHeader &header,
+                                   char &edgeType, uint64_t &source,
+                                   uint64_t &destination,
+                                   const char *&edgeData) {
+  edgeType = record[0];
+  source = readStreamVertex(record + 1, header.vertex_width);
+  destination =
+      readStreamVertex(record + 1 + header.vertex_width, header.vertex_width);
+  edgeData = record + 1 + 2 * header.vertex_width;
+}
+
+// Encodes one record into 'record', which must have header.recordSize()
+// bytes. edgeData points to header.edge_data_width bytes, or is nullptr to
+// zero the field.
+inline void encodeEdgeStreamRecord(char *record, const EdgeStreamHeader &header,
+                                   char edgeType, uint64_t source,
+                                   uint64_t destination, const void *edgeData) {
+  record[0] = edgeType;
+  writeStreamVertex(record + 1, source, header.vertex_width);
+  writeStreamVertex(record + 1 + header.vertex_width, destination,
+                    header.vertex_width);
+  if (header.edge_data_width > 0) {
+    char *field = record + 1 + 2 * header.vertex_width;
+    if (edgeData != nullptr) {
+      memcpy(field, edgeData, header.edge_data_width);
+    } else {
+      memset(field, 0, header.edge_data_width);
+    }
+  }
+}
+
+#endif
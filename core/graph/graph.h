@@ -26,8 +26,11 @@
 
 #ifndef GRAPH_H
 #define GRAPH_H
+#include "../common/blockRadixSort.h"
 #include "../common/parallel.h"
 #include "../common/quickSort.h"
+#include "slabAllocator.h"
+#include "vertexOrder.h"
 #include "vertex.h"
 #include <algorithm>
 #include <atomic>
@@ -41,6 +44,20 @@
 
 using namespace std;
 
+#ifdef EDGEDATA
+// Edge data arrays are grown and copied with memcpy (see slabAllocator.h)
+static_assert(isEdgeDataType<EdgeData>::value,
+              "EdgeData must derive from EdgeDataType<EdgeData> and be "
+              "trivially copyable");
+#endif
+
+// Deletions from a vertex with at most this many edges scan its adjacency list
+// once per deleted edge. The adjacency entries of larger vertices are looked up
+// in the sorted victims instead (see AdjacencyRep::markDeletedEdges()).
+#ifndef EDGE_DELETION_SCAN_DEGREE
+#define EDGE_DELETION_SCAN_DEGREE 32
+#endif
+
 struct edge {
   uintV source;
   uintV destination;
@@ -63,7 +80,7 @@ struct edgeArray {
   void del() {
     if (E != nullptr) {
 #ifdef EDGEDATA
-      parallel_for(uintV i = 0; i < size; i++) { edgeDataArray[i].del(); }
+      parallel_for(0, size, [&](uintV i) { edgeDataArray[i].del(); });
       free(edgeDataArray);
 #endif
       free(E);
@@ -80,188 +97,154 @@ struct edgeArray {
 #endif
 };
 
-struct edgesToDelete {
-  vector<uintV> outEdgesToDelete;
-  vector<uintV> inEdgesToDelete;
-#ifdef EDGEDATA
-  vector<EdgeData *> outEdgeDataToDelete;
-  vector<EdgeData *> inEdgeDataToDelete;
-#endif
-
-  edgesToDelete() {}
-  edgesToDelete(vector<uintV> _outEdgesToDelete, vector<uintV> _inEdgesToDelete)
-      : outEdgesToDelete(_outEdgesToDelete), inEdgesToDelete(_inEdgesToDelete) {
-  }
-
-  inline bool hasOutNeighbor(uintV outNeighbor) {
-    vector<uintV>::iterator index =
-        find(outEdgesToDelete.begin(), outEdgesToDelete.end(), outNeighbor);
-    if (index != outEdgesToDelete.end()) {
-      return true;
-    }
-    return false;
-  }
-
-  inline bool hasInNeighbor(uintV inNeighbor) {
-    vector<uintV>::iterator index =
-        find(inEdgesToDelete.begin(), inEdgesToDelete.end(), inNeighbor);
-    if (index != inEdgesToDelete.end()) {
-      return true;
-    }
-    return false;
-  }
-
-  inline long getIndexOfOutNeighbor(uintV outNeighbor, long start = 0) {
-
-    vector<uintV>::iterator it = find(outEdgesToDelete.begin() + start,
-                                      outEdgesToDelete.end(), outNeighbor);
-    if (it != outEdgesToDelete.end()) {
-      return it - outEdgesToDelete.begin();
-    }
-    return -1;
-  }
-
-  inline long getIndexOfInNeighbor(uintV inNeighbor, long start = 0) {
-    vector<uintV>::iterator it = find(inEdgesToDelete.begin() + start,
-                                      inEdgesToDelete.end(), inNeighbor);
-    if (it != inEdgesToDelete.end()) {
-      return it - inEdgesToDelete.begin();
-    }
-    return -1;
-  }
-
-  inline void clear() {
-    outEdgesToDelete.clear();
-    inEdgesToDelete.clear();
-#ifdef EDGEDATA
-    outEdgeDataToDelete.clear();
-    inEdgeDataToDelete.clear();
-#endif
-  }
-
-  inline void insertOutEdge(uintV v) { outEdgesToDelete.push_back(v); }
-
-  inline void insertInEdge(uintV v) { inEdgesToDelete.push_back(v); }
-
-#ifdef EDGEDATA
-  inline void insertOutData(EdgeData *edgeData) {
-    outEdgeDataToDelete.push_back(edgeData);
-  }
-
-  inline void insertInData(EdgeData *edgeData) {
-    inEdgeDataToDelete.push_back(edgeData);
-  }
-#endif
-};
-
 template <class E> struct SimpleCmp {
   bool operator()(E a, E b) { return a < b; }
 };
 
-template <class edge> struct MinSrcCmp {
-  bool operator()(edge a, edge b) { return a.source < b.source; }
-};
-
-template <class edge> struct MinDesCmp {
-  bool operator()(edge a, edge b) { return a.destination < b.destination; }
-};
-
+// Index over a batch of edge deletions, built in O(batch) time. The batch is
+// grouped twice: by source (out view) and by destination (in view). vertices
+// lists every vertex with a deletion, in increasing order, and the deletions
+// of vertices[j] are
+//   outNeighbors[outOffsets[j], outOffsets[j + 1])  (edges (vertices[j], v))
+//   inNeighbors[inOffsets[j], inOffsets[j + 1])     (edges (v, vertices[j]))
+// Deletions that are not in the graph are set to the max uintV value by
+// deleteEdges().
 struct edgeDeletionData {
-  edgesToDelete *dataMap;
   unsigned long numberOfDeletions;
   edge *edgesArray;
   uintV n;
-  bool *updatedVertices;
+
+  long numberOfVertices;
+  uintV *vertices;
+  long *outOffsets;
+  long *inOffsets;
+  uintV *outNeighbors;
+  uintV *inNeighbors;
+#ifdef EDGEDATA
+  EdgeData **outEdgeData;
+  EdgeData **inEdgeData;
+#endif
 
   edgeDeletionData(uintV _n) : n(_n) {
-    updatedVertices = newA(bool, n);
-    dataMap = new edgesToDelete[n];
-    parallel_for(uintV i = 0; i < n; i++) { updatedVertices[i] = 0; }
     numberOfDeletions = 0;
     edgesArray = nullptr;
-  }
-
-  inline void addEdge(edge &E) {
-    dataMap[E.source].insertOutEdge(E.destination);
-    dataMap[E.destination].insertInEdge(E.source);
-    updatedVertices[E.source] = 1;
-    updatedVertices[E.destination] = 1;
+    numberOfVertices = 0;
+    vertices = nullptr;
+    outOffsets = nullptr;
+    inOffsets = nullptr;
+    outNeighbors = nullptr;
+    inNeighbors = nullptr;
+#ifdef EDGEDATA
+    outEdgeData = nullptr;
+    inEdgeData = nullptr;
+#endif
   }
 
   void updateWithEdgesArray(edgeArray &edgeArrayToDelete) {
     edgesArray = edgeArrayToDelete.E;
     numberOfDeletions = edgeArrayToDelete.size;
+    long k = numberOfDeletions;
 
-    // sort on src
-    quickSort(edgesArray, numberOfDeletions, MinSrcCmp<edge>());
-
-    parallel_for(long i = 0; i < numberOfDeletions; i++) {
-      long prev = (i == 0) ? 0 : i - 1;
-      if ((i == 0) || (edgesArray[prev].source != edgesArray[i].source)) {
-        long j = i;
-        updatedVertices[edgesArray[i].source] = 1;
-        while ((j < numberOfDeletions) &&
-               (edgesArray[i].source == edgesArray[j].source)) {
-          dataMap[edgesArray[j].source].insertOutEdge(
-              edgesArray[j].destination);
+    outNeighbors = newA(uintV, k);
+    inNeighbors = newA(uintV, k);
 #ifdef EDGEDATA
-          dataMap[edgesArray[j].source].insertOutData(edgesArray[j].edgeData);
+    outEdgeData = newA(EdgeData *, k);
+    inEdgeData = newA(EdgeData *, k);
 #endif
-          j++;
-        }
-      }
-    }
-
-    // sort on dest
-    quickSort(edgesArray, numberOfDeletions, MinDesCmp<edge>());
-
-    parallel_for(long i = 0; i < numberOfDeletions; i++) {
-      long prev = (i == 0) ? 0 : i - 1;
-      if (i == 0 || edgesArray[prev].destination != edgesArray[i].destination) {
-        long j = i;
-        updatedVertices[edgesArray[i].destination] = 1;
-        while (j < numberOfDeletions &&
-               edgesArray[i].destination == edgesArray[j].destination) {
-          dataMap[edgesArray[j].destination].insertInEdge(edgesArray[j].source);
+    // touched[0, k) holds the sources of the out view and touched[k, 2k) the
+    // destinations of the in view
+    uintV *touched = newA(uintV, 2 * k);
+
+    // group on src. Vertex ids are below n, so the groupings are radix sorts
+    // on a single vertex id. The radix sort is stable, so sorting on dest
+    // first leaves the out neighbors of each source sorted, and the grouping
+    // on dest below leaves the in neighbors of each destination sorted.
+    intSort::iSort(edgesArray, k, n,
+                   [&](edge e) -> long { return e.destination; });
+    intSort::iSort(edgesArray, k, n, [&](edge e) -> long { return e.source; });
+    parallel_for(0, k, [&](long i) {
+      touched[i] = edgesArray[i].source;
+      outNeighbors[i] = edgesArray[i].destination;
 #ifdef EDGEDATA
-          dataMap[edgesArray[j].destination].insertInData(
-              edgesArray[j].edgeData);
+      outEdgeData[i] = edgesArray[i].edgeData;
 #endif
-          j++;
-        }
-      }
-    }
+    });
+
+    // group on dest
+    intSort::iSort(edgesArray, k, n,
+                   [&](edge e) -> long { return e.destination; });
+    parallel_for(0, k, [&](long i) {
+      touched[k + i] = edgesArray[i].destination;
+      inNeighbors[i] = edgesArray[i].source;
+#ifdef EDGEDATA
+      inEdgeData[i] = edgesArray[i].edgeData;
+#endif
+    });
+
+    uintV *sources = newA(uintV, k);
+    uintV *destinations = newA(uintV, k);
+    parallel_for(0, k, [&](long i) {
+      sources[i] = touched[i];
+      destinations[i] = touched[k + i];
+    });
+    intSort::iSort(touched, 2 * k, n, [&](uintV v) -> long { return v; });
+    bool *first = newA(bool, 2 * k);
+    parallel_for(0, 2 * k, [&](long i) {
+      first[i] = (i == 0) || (touched[i] != touched[i - 1]);
+    });
+    _seq<long> firsts = sequence::packIndex<long>(first, 2 * k);
+    numberOfVertices = firsts.n;
+    vertices = newA(uintV, numberOfVertices);
+    outOffsets = newA(long, numberOfVertices + 1);
+    inOffsets = newA(long, numberOfVertices + 1);
+    parallel_for(0, numberOfVertices, [&](long j) {
+      vertices[j] = touched[firsts.A[j]];
+      outOffsets[j] = lower_bound(sources, sources + k, vertices[j]) - sources;
+      inOffsets[j] = lower_bound(destinations, destinations + k, vertices[j]) -
+                     destinations;
+    });
+    outOffsets[numberOfVertices] = k;
+    inOffsets[numberOfVertices] = k;
+
+    firsts.del();
+    free(first);
+    free(sources);
+    free(destinations);
+    free(touched);
   }
 
-  edgesToDelete &getEdgeDeletionData(uintV vertex) { return dataMap[vertex]; }
+  inline long outDeletionCount(long j) const {
+    return outOffsets[j + 1] - outOffsets[j];
+  }
+
+  inline long inDeletionCount(long j) const {
+    return inOffsets[j + 1] - inOffsets[j];
+  }
 
   void reset() {
     numberOfDeletions = 0;
-    parallel_for(uintV i = 0; i < n; i++) {
-      if (updatedVertices[i] == 1) {
-        // Delete the entries in dataMap corresponding to the vertex i
-        dataMap[i].clear();
-        updatedVertices[i] = 0;
-      }
-    }
+    numberOfVertices = 0;
+    free(vertices);
+    free(outOffsets);
+    free(inOffsets);
+    free(outNeighbors);
+    free(inNeighbors);
+    vertices = nullptr;
+    outOffsets = nullptr;
+    inOffsets = nullptr;
+    outNeighbors = nullptr;
+    inNeighbors = nullptr;
+#ifdef EDGEDATA
+    free(outEdgeData);
+    free(inEdgeData);
+    outEdgeData = nullptr;
+    inEdgeData = nullptr;
+#endif
   }
 
-  void updateNumVertices(uintV maxVertex) {
-    if (n) {
-      delete[] dataMap;
-    }
-    updatedVertices = renewA(bool, updatedVertices, maxVertex);
-    parallel_for(uintV i = 0; i < maxVertex; i++) { updatedVertices[i] = 0; }
-    dataMap = new edgesToDelete[maxVertex];
-    n = maxVertex;
-  }
+  void updateNumVertices(uintV maxVertex) { n = maxVertex; }
 
-  void del() {
-    if (n) {
-      free(updatedVertices);
-      delete[] dataMap;
-    }
-  }
+  void del() { reset(); }
 };
 
 // **************************************************************
@@ -279,8 +262,11 @@ public:
   virtual uintE *getInEdgeOffsets() = 0;
   virtual void del() = 0;
   virtual void *updateVertices(uintV _verticesSize) = 0;
+  virtual void *relabel(const uintV *internalIds, const uintV *originalIds) = 0;
   virtual edgeArray addEdges(edgeArray &edgesToAdd, bool *updatedVertices) = 0;
   virtual void setSymmetric(bool flag) = 0;
+  virtual void setCapacityPolicy(const AdjacencyCapacityPolicy &policy) = 0;
+  virtual void printMemoryUsage() = 0;
   virtual edgeArray deleteEdges(edgeDeletionData &data, bool *updatedVertices,
                                 bool debugFlag) = 0;
   virtual ~Deletable() = default;
@@ -303,6 +289,17 @@ public:
   uintV *inEdgeUpdates = NULL;
   uintV *outEdgeUpdates = NULL;
 
+  // Own the per-vertex arrays. outEdgesArraySize and inEdgesArraySize hold
+  // their capacities, which are chosen by capacityPolicy when the arrays
+  // grow.
+  SlabAllocator<uintV> edgeSlabs;
+#ifdef EDGEDATA
+  SlabAllocator<EdgeData> edgeDataSlabs;
+#endif
+  AdjacencyCapacityPolicy capacityPolicy;
+
+  // Copies the CSR arrays into per-vertex arrays. The CSR arrays are not
+  // freed, they remain owned by the caller.
 #ifdef EDGEDATA
   AdjacencyRep(vertex *VV, unsigned long nn, unsigned long mm, uintV *ai,
                uintV *_inEdges = NULL, intE *_outEdgeOffsets = NULL,
@@ -333,14 +330,22 @@ public:
 #endif
     }
 
-    parallel_for(uintV i = 0; i < nn; i++) {
-      uintE outEdgesSize = V[i].getOutDegree();
-      outEdges[i] = newA(uintV, outEdgesSize);
-      outEdgesArraySize[i] = outEdgesSize;
-
+    auto outDegree = [&](long i) { return V[i].getOutDegree(); };
+    edgeSlabs.allocate(nn, outEdges, outDegree);
+#ifdef EDGEDATA
+    edgeDataSlabs.allocate(nn, outEdgeData, outDegree);
+#endif
+    if (_inEdges != NULL) {
+      auto inDegree = [&](long i) { return V[i].getInDegree(); };
+      edgeSlabs.allocate(nn, inEdges, inDegree);
 #ifdef EDGEDATA
-      outEdgeData[i] = newA(EdgeData, outEdgesSize);
+      edgeDataSlabs.allocate(nn, inEdgeData, inDegree);
 #endif
+    }
+
+    parallel_for(0, nn, [&](uintV i) {
+      uintE outEdgesSize = V[i].getOutDegree();
+      outEdgesArraySize[i] = outEdgesSize;
       for (uintE j = 0; j < outEdgesSize; j++) {
         outEdges[i][j] = ai[_outEdgeOffsets[i] + j];
 #ifdef EDGEDATA
@@ -356,12 +361,7 @@ public:
 
       if (_inEdges != NULL) {
         uintE inEdgesSize = V[i].getInDegree();
-        inEdges[i] = newA(uintV, inEdgesSize);
         inEdgesArraySize[i] = inEdgesSize;
-
-#ifdef EDGEDATA
-        inEdgeData[i] = newA(EdgeData, inEdgesSize);
-#endif
         for (uintE j = 0; j < inEdgesSize; j++) {
           inEdges[i][j] = _inEdges[_inEdgeOffsets[i] + j];
 #ifdef EDGEDATA
@@ -375,29 +375,47 @@ public:
         V[i].setInEdgeDataArray(inEdgeData[i]);
 #endif
       }
-    }
+    });
+  }
 
-    if (ai != NULL) {
-      free(ai);
-      free(_outEdgeOffsets);
+  void setSymmetric(bool flag) { symmetric = flag; }
+
+  void setCapacityPolicy(const AdjacencyCapacityPolicy &policy) {
+    capacityPolicy = policy;
+  }
+
+  // Bytes of the edges in the graph (used), of the arrays holding them
+  // (capacity) and of the slabs of the allocators (allocated). The
+  // allocated bytes that are in no array are in the free lists.
+  void printMemoryUsage() {
+    size_t edgeBytes = sizeof(uintV);
 #ifdef EDGEDATA
-      parallel_for(uintE i = 0; i < mm; i++) { _outEdgeData[i].del(); }
-      free(_outEdgeData);
+    edgeBytes += sizeof(EdgeData);
 #endif
-    }
-
-    if (_inEdges != NULL) {
-      free(_inEdges);
-      free(_inEdgeOffsets);
+    auto capacitySum = [&](uintE *arraySize) {
+      if (arraySize == NULL) {
+        return (size_t)0;
+      }
+      return sequence::reduce<size_t>(
+          (size_t)0, (size_t)n, addF<size_t>(),
+          [&](size_t i) { return (size_t)arraySize[i]; });
+    };
+    size_t edges = isSymmetric() ? m : 2 * m;
+    size_t capacity =
+        capacitySum(outEdgesArraySize) + capacitySum(inEdgesArraySize);
+    size_t allocated = edgeSlabs.allocatedBytes();
+    size_t freeBytes = edgeSlabs.freeBytes();
 #ifdef EDGEDATA
-      parallel_for(uintE i = 0; i < mm; i++) { _inEdgeData[i].del(); }
-      free(_inEdgeData);
+    allocated += edgeDataSlabs.allocatedBytes();
+    freeBytes += edgeDataSlabs.freeBytes();
 #endif
-    }
+    cout << "Adjacency memory (" << capacityPolicy.name()
+         << ") : used = " << edges * edgeBytes
+         << " bytes, capacity = " << capacity * edgeBytes
+         << " bytes, allocated = " << allocated << " bytes, free = " << freeBytes
+         << " bytes\n";
   }
 
-  void setSymmetric(bool flag) { symmetric = flag; }
-
   void *getOutEdges() { return outEdges; }
 
   void *getInEdges() { return inEdges; }
@@ -434,30 +452,31 @@ public:
       inEdgeData = renewA(EdgeData *, inEdgeData, n);
 #endif
 
-      parallel_for(uintV i = 0; i < currentVertexSize; i++) {
+      parallel_for(0, currentVertexSize, [&](uintV i) {
         V[i].setOutNeighbors(outEdges[i]);
         V[i].setInNeighbors(inEdges[i]);
 #ifdef EDGEDATA
         V[i].setOutEdgeDataArray(outEdgeData[i]);
         V[i].setInEdgeDataArray(inEdgeData[i]);
 #endif
-      }
+      });
 
-      parallel_for(uintV i = currentVertexSize; i < n; i++) {
+      parallel_for(currentVertexSize, n, [&](uintV i) {
         V[i].setOutDegree(0);
         V[i].setInDegree(0);
-        // TODO : What is this doing??
-        outEdges[i] = newA(uintV, 0);
-        inEdges[i] = newA(uintV, 0);
+        outEdges[i] = NULL;
+        inEdges[i] = NULL;
         V[i].setOutNeighbors(outEdges[i]);
         V[i].setInNeighbors(inEdges[i]);
 #ifdef EDGEDATA
+        outEdgeData[i] = NULL;
+        inEdgeData[i] = NULL;
         V[i].setOutEdgeDataArray(outEdgeData[i]);
         V[i].setInEdgeDataArray(inEdgeData[i]);
 #endif
         outEdgesArraySize[i] = 0;
         inEdgesArraySize[i] = 0;
-      }
+      });
       return V;
     }
     return nullptr;
@@ -475,35 +494,123 @@ public:
       outEdgeData = renewA(EdgeData *, outEdgeData, n);
 #endif
 
-      parallel_for(uintV i = 0; i < currentVertexSize; i++) {
+      parallel_for(0, currentVertexSize, [&](uintV i) {
         V[i].setOutNeighbors(outEdges[i]);
 #ifdef EDGEDATA
         V[i].setOutEdgeDataArray(outEdgeData[i]);
 #endif
-      }
+      });
 
-      parallel_for(uintV i = currentVertexSize; i < n; i++) {
+      parallel_for(currentVertexSize, n, [&](uintV i) {
         V[i].setOutDegree(0);
-        outEdges[i] = newA(uintV, 0);
+        outEdges[i] = NULL;
         V[i].setOutNeighbors(outEdges[i]);
 #ifdef EDGEDATA
+        outEdgeData[i] = NULL;
         V[i].setOutEdgeDataArray(outEdgeData[i]);
 #endif
         outEdgesArraySize[i] = 0;
-      }
+      });
       return V;
     }
     return nullptr;
   }
 
+  template <class T> void permute(T *&A, const uintV *originalIds) {
+    if (A == NULL) {
+      return;
+    }
+    T *permuted = newA(T, n);
+    parallel_for(0, n, [&](uintV i) { permuted[i] = A[originalIds[i]]; });
+    free(A);
+    A = permuted;
+  }
+
+  // Moves vertex originalIds[i] to i and renames each neighbor v to
+  // internalIds[v]. The adjacency arrays move with their vertex.
+  void *relabel(const uintV *internalIds, const uintV *originalIds) {
+    permute(V, originalIds);
+    permute(outEdges, originalIds);
+    permute(outEdgesArraySize, originalIds);
+    permute(inEdges, originalIds);
+    permute(inEdgesArraySize, originalIds);
+#ifdef EDGEDATA
+    permute(outEdgeData, originalIds);
+    permute(inEdgeData, originalIds);
+#endif
+    parallel_for(0, n, [&](uintV i) {
+      intE outDegree = V[i].getOutDegree();
+      granular_for(j, 0, outDegree, (outDegree > 1024), {
+        outEdges[i][j] = internalIds[outEdges[i][j]];
+      });
+      if (inEdges != NULL) {
+        intE inDegree = V[i].getInDegree();
+        granular_for(j, 0, inDegree, (inDegree > 1024),
+                     { inEdges[i][j] = internalIds[inEdges[i][j]]; });
+      }
+    });
+    return V;
+  }
+
+  // Moves the arrays of the vertices without room for their outEdgeUpdates
+  // to larger blocks. A whole batch only needs a few allocations.
+  void growOutEdgeArrays() {
+    uintE *newCapacity = newA(uintE, n);
+    parallel_for(0, n, [&](uintV i) {
+      uintE required = V[i].getOutDegree() + outEdgeUpdates[i];
+      newCapacity[i] = (required > outEdgesArraySize[i])
+                           ? capacityPolicy.capacity(required)
+                           : outEdgesArraySize[i];
+    });
+    auto outDegree = [&](long i) { return V[i].getOutDegree(); };
+    edgeSlabs.reallocate(n, outEdges, outEdgesArraySize, newCapacity,
+                         outDegree);
+#ifdef EDGEDATA
+    edgeDataSlabs.reallocate(n, outEdgeData, outEdgesArraySize, newCapacity,
+                             outDegree);
+#endif
+    parallel_for(0, n, [&](uintV i) {
+      outEdgesArraySize[i] = newCapacity[i];
+      V[i].setOutNeighbors(outEdges[i]);
+#ifdef EDGEDATA
+      V[i].setOutEdgeDataArray(outEdgeData[i]);
+#endif
+    });
+    free(newCapacity);
+  }
+
+  void growInEdgeArrays() {
+    uintE *newCapacity = newA(uintE, n);
+    parallel_for(0, n, [&](uintV i) {
+      uintE required = V[i].getInDegree() + inEdgeUpdates[i];
+      newCapacity[i] = (required > inEdgesArraySize[i])
+                           ? capacityPolicy.capacity(required)
+                           : inEdgesArraySize[i];
+    });
+    auto inDegree = [&](long i) { return V[i].getInDegree(); };
+    edgeSlabs.reallocate(n, inEdges, inEdgesArraySize, newCapacity, inDegree);
+#ifdef EDGEDATA
+    edgeDataSlabs.reallocate(n, inEdgeData, inEdgesArraySize, newCapacity,
+                             inDegree);
+#endif
+    parallel_for(0, n, [&](uintV i) {
+      inEdgesArraySize[i] = newCapacity[i];
+      V[i].setInNeighbors(inEdges[i]);
+#ifdef EDGEDATA
+      V[i].setInEdgeDataArray(inEdgeData[i]);
+#endif
+    });
+    free(newCapacity);
+  }
+
   edgeArray addEdges_symmetric(edgeArray &edgesToAdd, bool *updatedVertices) {
-    parallel_for(uintV i = 0; i < n; i++) { outEdgeUpdates[i] = 0; }
+    parallel_for(0, n, [&](uintV i) { outEdgeUpdates[i] = 0; });
 
     edge *E = edgesToAdd.E;
     uintE size = edgesToAdd.size;
     // for each new edge, we increment the outDegreeOffset of the source
     // and we increment the inDegreeOffset of the destination
-    parallel_for(uintE i = 0; i < size; i++) {
+    parallel_for(0, size, [&](uintE i) {
       uintV source = E[i].source;
       uintV destination = E[i].destination;
 
@@ -513,32 +620,11 @@ public:
 
       updatedVertices[source] = 1;
       updatedVertices[destination] = 1;
-    }
+    });
 
-    parallel_for(uintE i = 0; i < n; i++) {
-#ifdef INCLUDEEXTRABUFFERSPACE
-      if (outEdgeUpdates[i] &&
-          (outEdgeUpdates[i] + V[i].getOutDegree()) > outEdgesArraySize[i]) {
-        outEdgesArraySize[i] =
-            V[i].getOutDegree() + outEdgeUpdates[i] + EDGE_ARRAY_BUFFER;
-        outEdges[i] = renewA(uintV, outEdges[i], outEdgesArraySize[i]);
-        V[i].setOutNeighbors(outEdges[i]);
-      }
-#else
-      if (outEdgeUpdates[i]) {
-        outEdges[i] = renewA(uintV, outEdges[i],
-                             (V[i].getOutDegree() + outEdgeUpdates[i]));
-        V[i].setOutNeighbors(outEdges[i]);
-#ifdef EDGEDATA
-        outEdgeData[i] = renewA(EdgeData, outEdgeData[i],
-                                (V[i].getOutDegree() + outEdgeUpdates[i]));
-        V[i].setOutEdgeDataArray(outEdgeData[i]);
-#endif
-      }
-#endif
-    }
+    growOutEdgeArrays();
 
-    parallel_for(uintE i = 0; i < size; i++) {
+    parallel_for(0, size, [&](uintE i) {
       uintV source = E[i].source;
       uintV destination = E[i].destination;
 #ifdef EDGEDATA
@@ -556,7 +642,7 @@ public:
       new (outEdgeData[destination] + inIndex) EdgeData();
       outEdgeData[destination][inIndex].setEdgeDataFromPtr(edgeData);
 #endif
-    }
+    });
 
     long curr_size = edgesToAdd.size;
 #ifdef EDGEDATA
@@ -600,16 +686,16 @@ public:
       return addEdges_symmetric(edgesToAdd, updatedVertices);
     }
 
-    parallel_for(uintV i = 0; i < n; i++) {
+    parallel_for(0, n, [&](uintV i) {
       outEdgeUpdates[i] = 0;
       inEdgeUpdates[i] = 0;
-    }
+    });
 
     edge *E = edgesToAdd.E;
     uintE size = edgesToAdd.size;
     // for each new edge, we increment the outDegreeOffset of the source
     // and we increment the inDegreeOffset of the destination
-    parallel_for(uintE i = 0; i < size; i++) {
+    parallel_for(0, size, [&](uintE i) {
       uintV source = E[i].source;
       uintV destination = E[i].destination;
 
@@ -619,49 +705,12 @@ public:
 
       updatedVertices[source] = 1;
       updatedVertices[destination] = 1;
-    }
+    });
 
-    parallel_for(uintV i = 0; i < n; i++) {
-#ifdef INCLUDEEXTRABUFFERSPACE
-      if (outEdgeUpdates[i] &&
-          (outEdgeUpdates[i] + V[i].getOutDegree()) > outEdgesArraySize[i]) {
-        outEdgesArraySize[i] =
-            V[i].getOutDegree() + outEdgeUpdates[i] + EDGE_ARRAY_BUFFER;
-        outEdges[i] = renewA(uintV, outEdges[i], outEdgesArraySize[i]);
-        V[i].setOutNeighbors(outEdges[i]);
-      }
-      if (inEdgeUpdates[i] &&
-          (inEdgeUpdates[i] + V[i].getInDegree()) > inEdgesArraySize[i]) {
-        inEdgesArraySize[i] =
-            V[i].getInDegree() + inEdgeUpdates[i] + EDGE_ARRAY_BUFFER;
-        inEdges[i] = renewA(uintV, inEdges[i], inEdgesArraySize[i]);
-        V[i].setInNeighbors(inEdges[i]);
-      }
-#else
-      if (outEdgeUpdates[i]) {
-        outEdges[i] = renewA(uintV, outEdges[i],
-                             (V[i].getOutDegree() + outEdgeUpdates[i]));
-        V[i].setOutNeighbors(outEdges[i]);
-#ifdef EDGEDATA
-        outEdgeData[i] = renewA(EdgeData, outEdgeData[i],
-                                (V[i].getOutDegree() + outEdgeUpdates[i]));
-        V[i].setOutEdgeDataArray(outEdgeData[i]);
-#endif
-      }
-      if (inEdgeUpdates[i]) {
-        inEdges[i] =
-            renewA(uintV, inEdges[i], (V[i].getInDegree() + inEdgeUpdates[i]));
-        V[i].setInNeighbors(inEdges[i]);
-#ifdef EDGEDATA
-        inEdgeData[i] = renewA(EdgeData, inEdgeData[i],
-                               (V[i].getInDegree() + inEdgeUpdates[i]));
-        V[i].setInEdgeDataArray(inEdgeData[i]);
-#endif
-      }
-#endif
-    }
+    growOutEdgeArrays();
+    growInEdgeArrays();
 
-    parallel_for(uintE i = 0; i < edgesToAdd.size; i++) {
+    parallel_for(0, edgesToAdd.size, [&](uintE i) {
       uintV source = E[i].source;
       uintV destination = E[i].destination;
 #ifdef EDGEDATA
@@ -680,18 +729,60 @@ public:
       new (inEdgeData[destination] + inIndex) EdgeData();
       inEdgeData[destination][inIndex].setEdgeDataFromPtr(edgeData);
 #endif
-    }
+    });
 
     unsigned long newSize = m + edgesToAdd.size;
     m = newSize;
     return edgesToAdd;
   }
 
+  // Tombstones one entry of edges[0, degree) for each victim, or sets the
+  // victim to the tombstone if there is no entry left for it. The victims are
+  // sorted (see edgeDeletionData), so each entry is looked up with a binary
+  // search in O(degree * log k) instead of the O(k * degree) CAS scans of
+  // deleteEdges(). matched[0, k) is scratch space: matched[j] counts the
+  // entries found for the run of equal victims starting at j.
+  static void markDeletedEdges(uintV *edges, long degree, uintV *victims,
+                               long k, long *matched) {
+    uintV maxValue = numeric_limits<uintV>::max();
+    for (long j = 0; j < k; j++) {
+      matched[j] = 0;
+    }
+    granular_for(e, 0, degree, (degree > 1024), {
+      uintV ngh = edges[e];
+      long first = lower_bound(victims, victims + k, ngh) - victims;
+      if (first < k && victims[first] == ngh) {
+        long count = upper_bound(victims + first, victims + k, ngh) -
+                     (victims + first);
+        long curr = matched[first];
+        while (curr < count) {
+          if (CAS(&matched[first], curr, curr + 1)) {
+            edges[e] = maxValue;
+            break;
+          }
+          curr = matched[first];
+        }
+      }
+    });
+
+    for (long first = 0; first < k;) {
+      long last = first;
+      while (last < k && victims[last] == victims[first]) {
+        last++;
+      }
+      for (long j = first + matched[first]; j < last; j++) {
+        victims[j] = maxValue;
+      }
+      first = last;
+    }
+  }
+
   // Todo: change type of edges to be signed
   edgeArray deleteEdges_symmetric(edgeDeletionData &deletionsData,
                                   bool *updatedVertices, bool debugFlag) {
     uintV maxValue = numeric_limits<uintV>::max();
     intE numberOfSuccessfulDeletions = 0;
+    long numberOfVertices = deletionsData.numberOfVertices;
 
     edge *ED = newA(edge, deletionsData.numberOfDeletions * 2);
 #ifdef EDGEDATA
@@ -700,23 +791,29 @@ public:
 #endif
 
     // TODO : Why?
-    uintE *outDegree = newA(uintE, n);
-    uintE *inDegree = newA(uintE, n);
-
-    parallel_for(uintV i = 0; i < n; i++) {
-      if (deletionsData.updatedVertices[i] == 1) {
-        outDegree[i] = V[i].getOutDegree();
-        edgesToDelete *currentEdgesToDelete =
-            &deletionsData.getEdgeDeletionData(i);
-        vector<uintV> &outEdgesToDelete =
-            currentEdgesToDelete->outEdgesToDelete;
-
-        parallel_for(intE j = 0; j < outEdgesToDelete.size(); j++) {
+    uintE *outDegree = newA(uintE, numberOfVertices);
+    uintE *inDegree = newA(uintE, numberOfVertices);
+    // Scratch space of markDeletedEdges(), indexed like the victims
+    long *matched = newA(long, deletionsData.numberOfDeletions);
+
+    parallel_for(0, numberOfVertices, [&](long v) {
+      uintV i = deletionsData.vertices[v];
+      outDegree[v] = V[i].getOutDegree();
+      uintV *outEdgesToDelete =
+          deletionsData.outNeighbors + deletionsData.outOffsets[v];
+      long outDeletionCount = deletionsData.outDeletionCount(v);
+
+      if (outDegree[v] > EDGE_DELETION_SCAN_DEGREE) {
+        markDeletedEdges(outEdges[i], outDegree[v], outEdgesToDelete,
+                         outDeletionCount,
+                         matched + deletionsData.outOffsets[v]);
+      } else {
+        parallel_for(0, outDeletionCount, [&](intE j) {
           uintV targetOutNgh = outEdgesToDelete[j];
           uintV *currOutEdges = outEdges[i];
 
           bool deletionSuccessful = false;
-          for (intE k = 0; k < outDegree[i]; k++) {
+          for (intE k = 0; k < outDegree[v]; k++) {
             if (targetOutNgh == currOutEdges[k]) {
               bool casSuccessful;
               do {
@@ -731,66 +828,65 @@ public:
           if (deletionSuccessful == false) {
             outEdgesToDelete[j] = maxValue;
           }
-        }
+        });
       }
-    }
+    });
 
-    parallel_for(uintV i = 0; i < n; i++) {
-      if (deletionsData.updatedVertices[i] == 1) {
-        uintV *currOutEdges = outEdges[i];
+    parallel_for(0, numberOfVertices, [&](long v) {
+      uintV i = deletionsData.vertices[v];
+      uintV *currOutEdges = outEdges[i];
 #ifdef EDGEDATA
-        EdgeData *currOutEdgeData = outEdgeData[i];
+      EdgeData *currOutEdgeData = outEdgeData[i];
 #endif
 
-        edgesToDelete *currentEdgesToDelete =
-            &deletionsData.getEdgeDeletionData(i);
-        intE last_non_deleted_index;
-        vector<uintV> &outEdgesToDelete =
-            currentEdgesToDelete->outEdgesToDelete;
-        intE to_delete_count = outEdgesToDelete.size();
+      intE last_non_deleted_index;
+      uintV *outEdgesToDelete =
+          deletionsData.outNeighbors + deletionsData.outOffsets[v];
+      intE to_delete_count = deletionsData.outDeletionCount(v);
 
-        intE actual_to_delete_count = 0;
-        for (intE i = 0; i < to_delete_count; i++) {
-          if (outEdgesToDelete[i] != maxValue) {
-            actual_to_delete_count++;
-          }
+      intE actual_to_delete_count = 0;
+      for (intE i = 0; i < to_delete_count; i++) {
+        if (outEdgesToDelete[i] != maxValue) {
+          actual_to_delete_count++;
         }
-        intE total_swapped = 0;
+      }
+      intE total_swapped = 0;
 
-        for (intE k = outDegree[i] - 1,
-                  last_non_deleted_index = outDegree[i] - 1;
-             k >= 0; k--) {
-          if (currOutEdges[k] == maxValue) {
-            currOutEdges[k] = currOutEdges[last_non_deleted_index];
+      for (intE k = outDegree[v] - 1, last_non_deleted_index = outDegree[v] - 1;
+           k >= 0; k--) {
+        if (currOutEdges[k] == maxValue) {
+          currOutEdges[k] = currOutEdges[last_non_deleted_index];
 #ifdef EDGEDATA
-            currOutEdgeData[k].del();
-            currOutEdgeData[k] = currOutEdgeData[last_non_deleted_index];
+          currOutEdgeData[k].del();
+          currOutEdgeData[k] = currOutEdgeData[last_non_deleted_index];
 #endif
-            last_non_deleted_index--;
-            total_swapped++;
-          }
-          if (total_swapped == actual_to_delete_count) {
-            break;
-          }
+          last_non_deleted_index--;
+          total_swapped++;
+        }
+        if (total_swapped == actual_to_delete_count) {
+          break;
         }
-
-        V[i].setOutDegree(outDegree[i] - total_swapped);
-        pbbs::fetch_and_add(&numberOfSuccessfulDeletions, total_swapped);
       }
-    }
 
-    parallel_for(uintV i = 0; i < n; i++) {
-      if (deletionsData.updatedVertices[i] == 1) {
-        inDegree[i] = V[i].getOutDegree();
-        edgesToDelete *currentEdgesToDelete =
-            &deletionsData.getEdgeDeletionData(i);
-        vector<uintV> &inEdgesToDelete = currentEdgesToDelete->inEdgesToDelete;
-        parallel_for(uintV j = 0;
-                     j < currentEdgesToDelete->inEdgesToDelete.size(); j++) {
+      V[i].setOutDegree(outDegree[v] - total_swapped);
+      pbbs::fetch_and_add(&numberOfSuccessfulDeletions, total_swapped);
+    });
+
+    parallel_for(0, numberOfVertices, [&](long v) {
+      uintV i = deletionsData.vertices[v];
+      inDegree[v] = V[i].getOutDegree();
+      uintV *inEdgesToDelete =
+          deletionsData.inNeighbors + deletionsData.inOffsets[v];
+      long inDeletionCount = deletionsData.inDeletionCount(v);
+      if (inDegree[v] > EDGE_DELETION_SCAN_DEGREE) {
+        markDeletedEdges(outEdges[i], inDegree[v], inEdgesToDelete,
+                         inDeletionCount, matched + deletionsData.inOffsets[v]);
+      } else {
+        parallel_for(0, inDeletionCount, [&](intE j) {
           uintV targetInNgh = inEdgesToDelete[j];
           uintV *currInEdges = outEdges[i];
           bool deletionSuccessful = false;
-          for (intE k = 0; k < inDegree[i]; k++) {
+          for (intE k = 0; k < inDegree[v]; k++) {
             if (targetInNgh == currInEdges[k]) {
               bool casSuccessful;
               do {
@@ -805,98 +901,90 @@ public:
           if (deletionSuccessful == false) {
             inEdgesToDelete[j] = maxValue;
           }
-        }
+        });
       }
-    }
+    });
 
-    parallel_for(uintV i = 0; i < n; i++) {
-      if (deletionsData.updatedVertices[i] == 1) {
-        uintV *currInEdges = outEdges[i];
+    parallel_for(0, numberOfVertices, [&](long v) {
+      uintV i = deletionsData.vertices[v];
+      uintV *currInEdges = outEdges[i];
 #ifdef EDGEDATA
-        EdgeData *currInEdgeData = outEdgeData[i];
+      EdgeData *currInEdgeData = outEdgeData[i];
 #endif
 
-        edgesToDelete *currentEdgesToDelete =
-            &deletionsData.getEdgeDeletionData(i);
-        vector<uintV> &inEdgesToDelete = currentEdgesToDelete->inEdgesToDelete;
-        intE last_non_deleted_index;
+      uintV *inEdgesToDelete =
+          deletionsData.inNeighbors + deletionsData.inOffsets[v];
+      intE last_non_deleted_index;
 
-        intE to_delete_count = inEdgesToDelete.size();
+      intE to_delete_count = deletionsData.inDeletionCount(v);
 
-        intE actual_to_delete_count = 0;
-        for (intE i = 0; i < to_delete_count; i++) {
-          if (inEdgesToDelete[i] != maxValue) {
-            actual_to_delete_count++;
-          }
+      intE actual_to_delete_count = 0;
+      for (intE i = 0; i < to_delete_count; i++) {
+        if (inEdgesToDelete[i] != maxValue) {
+          actual_to_delete_count++;
         }
+      }
 
-        intE total_swapped = 0;
+      intE total_swapped = 0;
 
-        for (intE k = inDegree[i] - 1, last_non_deleted_index = inDegree[i] - 1;
-             k >= 0; k--) {
-          if (currInEdges[k] == maxValue) {
-            currInEdges[k] = currInEdges[last_non_deleted_index];
+      for (intE k = inDegree[v] - 1, last_non_deleted_index = inDegree[v] - 1;
+           k >= 0; k--) {
+        if (currInEdges[k] == maxValue) {
+          currInEdges[k] = currInEdges[last_non_deleted_index];
 #ifdef EDGEDATA
-            currInEdgeData[k].del();
-            currInEdgeData[k] = currInEdgeData[last_non_deleted_index];
+          currInEdgeData[k].del();
+          currInEdgeData[k] = currInEdgeData[last_non_deleted_index];
 #endif
-            last_non_deleted_index--;
-            total_swapped++;
-          }
-          if (total_swapped == actual_to_delete_count) {
-            break;
-          }
+          last_non_deleted_index--;
+          total_swapped++;
+        }
+        if (total_swapped == actual_to_delete_count) {
+          break;
         }
-        V[i].setOutDegree(inDegree[i] - total_swapped);
-        pbbs::fetch_and_add(&numberOfSuccessfulDeletions, total_swapped);
       }
-    }
+      V[i].setOutDegree(inDegree[v] - total_swapped);
+      pbbs::fetch_and_add(&numberOfSuccessfulDeletions, total_swapped);
+    });
     intE edgeArrayIndex = 0;
-    for (uintV i = 0; i < n; i++) {
-      if (deletionsData.updatedVertices[i] == 1) {
-        edgesToDelete *currentEdgesToDelete =
-            &deletionsData.getEdgeDeletionData(i);
-        vector<uintV> &outEdgesToDelete =
-            currentEdgesToDelete->outEdgesToDelete;
-        vector<uintV> &inEdgesToDelete = currentEdgesToDelete->inEdgesToDelete;
+    for (long v = 0; v < numberOfVertices; v++) {
+      uintV i = deletionsData.vertices[v];
+      long outOffset = deletionsData.outOffsets[v];
+      long inOffset = deletionsData.inOffsets[v];
+
+      for (intE j = 0; j < deletionsData.outDeletionCount(v); j++) {
+        uintV outNgh = deletionsData.outNeighbors[outOffset + j];
+        if (outNgh != maxValue) {
+          intE edIndex = edgeArrayIndex++;
+          ED[edIndex].source = i;
+          ED[edIndex].destination = outNgh;
 #ifdef EDGEDATA
-        vector<EdgeData *> &outEdgeDataToDelete =
-            currentEdgesToDelete->outEdgeDataToDelete;
-        vector<EdgeData *> &inEdgeDataToDelete =
-            currentEdgesToDelete->inEdgeDataToDelete;
+          new (edgeDataWeight + edIndex) EdgeData();
+          ED[edIndex].edgeData = &edgeDataWeight[edIndex];
+          ED[edIndex].edgeData->setEdgeDataFromPtr(
+              deletionsData.outEdgeData[outOffset + j]);
 #endif
-
-        for (intE j = 0; j < outEdgesToDelete.size(); j++) {
-          if (outEdgesToDelete[j] != maxValue) {
-            intE edIndex = edgeArrayIndex++;
-            ED[edIndex].source = i;
-            ED[edIndex].destination = outEdgesToDelete[j];
-#ifdef EDGEDATA
-            new (edgeDataWeight + edIndex) EdgeData();
-            ED[edIndex].edgeData = &edgeDataWeight[edIndex];
-            ED[edIndex].edgeData->setEdgeDataFromPtr(outEdgeDataToDelete[j]);
-#endif
-          } else {
-            if (debugFlag) {
-              cerr << "INVALID: " << i << "\t" << outEdgesToDelete[j] << "\n";
-            }
+        } else {
+          if (debugFlag) {
+            cerr << "INVALID: " << i << "\t" << outNgh << "\n";
           }
         }
+      }
 
-        for (intE j = 0; j < inEdgesToDelete.size(); j++) {
-          if (inEdgesToDelete[j] != maxValue) {
-            intE edIndex = edgeArrayIndex++;
-            ED[edIndex].source = i;
-            ED[edIndex].destination = inEdgesToDelete[j];
+      for (intE j = 0; j < deletionsData.inDeletionCount(v); j++) {
+        uintV inNgh = deletionsData.inNeighbors[inOffset + j];
+        if (inNgh != maxValue) {
+          intE edIndex = edgeArrayIndex++;
+          ED[edIndex].source = i;
+          ED[edIndex].destination = inNgh;
 #ifdef EDGEDATA
-            new (edgeDataWeight + edIndex) EdgeData();
-            ED[edIndex].edgeData = &edgeDataWeight[edIndex];
-            ED[edIndex].edgeData->setEdgeDataFromPtr(inEdgeDataToDelete[j]);
+          new (edgeDataWeight + edIndex) EdgeData();
+          ED[edIndex].edgeData = &edgeDataWeight[edIndex];
+          ED[edIndex].edgeData->setEdgeDataFromPtr(
+              deletionsData.inEdgeData[inOffset + j]);
 #endif
-          } else {
-            if (debugFlag) {
-              cerr << "INVALID: " << i << "\t" << inEdgesToDelete[j] << "\n";
-            }
+        } else {
+          if (debugFlag) {
+            cerr << "INVALID: " << i << "\t" << inNgh << "\n";
           }
         }
       }
@@ -904,6 +992,7 @@ public:
 
     free(outDegree);
     free(inDegree);
+    free(matched);
     uintE newSize = m - numberOfSuccessfulDeletions;
 
     m = newSize;
@@ -921,32 +1010,38 @@ public:
     if (isSymmetric()) {
       return deleteEdges_symmetric(deletionsData, updatedVertices, debugFlag);
     }
+    long numberOfVertices = deletionsData.numberOfVertices;
     edge *ED = newA(edge, deletionsData.numberOfDeletions);
 #ifdef EDGEDATA
     EdgeData *edgeDataWeight = newA(EdgeData, deletionsData.numberOfDeletions);
 #endif
-    intE *outDegree = newA(intE, n);
-    intE *inDegree = newA(intE, n);
-
-    parallel_for(uintV i = 0; i < n; i++) {
-      if (deletionsData.updatedVertices[i] == 1) {
-        outDegree[i] = V[i].getOutDegree();
-        inDegree[i] = V[i].getInDegree();
-      }
-    }
-
-    parallel_for(uintV i = 0; i < n; i++) {
-      if (deletionsData.updatedVertices[i] == 1) {
-        edgesToDelete *currentEdgesToDelete =
-            &deletionsData.getEdgeDeletionData(i);
-        vector<uintV> &outEdgesToDelete =
-            currentEdgesToDelete->outEdgesToDelete;
-        parallel_for(intE j = 0; j < outEdgesToDelete.size(); j++) {
+    intE *outDegree = newA(intE, numberOfVertices);
+    intE *inDegree = newA(intE, numberOfVertices);
+    // Scratch space of markDeletedEdges(), indexed like the victims
+    long *matched = newA(long, deletionsData.numberOfDeletions);
+
+    parallel_for(0, numberOfVertices, [&](long v) {
+      uintV i = deletionsData.vertices[v];
+      outDegree[v] = V[i].getOutDegree();
+      inDegree[v] = V[i].getInDegree();
+    });
+
+    parallel_for(0, numberOfVertices, [&](long v) {
+      uintV i = deletionsData.vertices[v];
+      uintV *outEdgesToDelete =
+          deletionsData.outNeighbors + deletionsData.outOffsets[v];
+      long outDeletionCount = deletionsData.outDeletionCount(v);
+      if (outDegree[v] > EDGE_DELETION_SCAN_DEGREE) {
+        markDeletedEdges(outEdges[i], outDegree[v], outEdgesToDelete,
+                         outDeletionCount,
+                         matched + deletionsData.outOffsets[v]);
+      } else {
+        parallel_for(0, outDeletionCount, [&](intE j) {
           uintV targetOutNgh = outEdgesToDelete[j];
           uintV *currOutEdges = outEdges[i];
 
           bool deletionSuccessful = false;
-          for (intE k = 0; k < outDegree[i]; k++) {
+          for (intE k = 0; k < outDegree[v]; k++) {
             if (targetOutNgh == currOutEdges[k]) {
               bool casSuccessful;
               do {
@@ -961,21 +1056,25 @@ public:
           if (deletionSuccessful == false) {
             outEdgesToDelete[j] = maxValue;
           }
-        }
+        });
       }
-    }
-
-    parallel_for(uintV i = 0; i < n; i++) {
-      if (deletionsData.updatedVertices[i] == 1) {
-        edgesToDelete *currentEdgesToDelete =
-            &deletionsData.getEdgeDeletionData(i);
-        vector<uintV> &inEdgesToDelete = currentEdgesToDelete->inEdgesToDelete;
-        parallel_for(intE j = 0; j < inEdgesToDelete.size(); j++) {
+    });
+
+    parallel_for(0, numberOfVertices, [&](long v) {
+      uintV i = deletionsData.vertices[v];
+      uintV *inEdgesToDelete =
+          deletionsData.inNeighbors + deletionsData.inOffsets[v];
+      long inDeletionCount = deletionsData.inDeletionCount(v);
+      if (inDegree[v] > EDGE_DELETION_SCAN_DEGREE) {
+        markDeletedEdges(inEdges[i], inDegree[v], inEdgesToDelete,
+                         inDeletionCount, matched + deletionsData.inOffsets[v]);
+      } else {
+        parallel_for(0, inDeletionCount, [&](intE j) {
           uintV targetInNgh = inEdgesToDelete[j];
           uintV *currInEdges = inEdges[i];
 
           bool deletionSuccessful = false;
-          for (intE k = 0; k < inDegree[i]; k++) {
+          for (intE k = 0; k < inDegree[v]; k++) {
             if (targetInNgh == currInEdges[k]) {
               bool casSuccessful;
               do {
@@ -991,110 +1090,100 @@ public:
           if (deletionSuccessful == false) {
             inEdgesToDelete[j] = maxValue;
           }
-        }
+        });
       }
-    }
+    });
 
-    parallel_for(uintV i = 0; i < n; i++) {
-      if (deletionsData.updatedVertices[i] == 1) {
-        intE numberOfDeletions = 0;
-        uintV *currOutEdges = outEdges[i];
-        uintV *currInEdges = inEdges[i];
+    parallel_for(0, numberOfVertices, [&](long v) {
+      uintV i = deletionsData.vertices[v];
+      uintV *currOutEdges = outEdges[i];
+      uintV *currInEdges = inEdges[i];
 #ifdef EDGEDATA
-        EdgeData *currOutEdgeData = outEdgeData[i];
-        EdgeData *currInEdgeData = inEdgeData[i];
+      EdgeData *currOutEdgeData = outEdgeData[i];
+      EdgeData *currInEdgeData = inEdgeData[i];
 #endif
 
-        edgesToDelete *currentEdgesToDelete =
-            &deletionsData.getEdgeDeletionData(i);
-        vector<uintV> &outEdgesToDelete =
-            currentEdgesToDelete->outEdgesToDelete;
-        intE last_non_deleted_index;
-        intE to_delete_count = outEdgesToDelete.size();
+      uintV *outEdgesToDelete =
+          deletionsData.outNeighbors + deletionsData.outOffsets[v];
+      intE last_non_deleted_index;
+      intE to_delete_count = deletionsData.outDeletionCount(v);
 
-        intE actual_to_delete_count = 0;
-        for (intE i = 0; i < to_delete_count; i++) {
-          if (outEdgesToDelete[i] != maxValue) {
-            actual_to_delete_count++;
-          }
+      intE actual_to_delete_count = 0;
+      for (intE i = 0; i < to_delete_count; i++) {
+        if (outEdgesToDelete[i] != maxValue) {
+          actual_to_delete_count++;
         }
-        intE total_swapped = 0;
+      }
+      intE total_swapped = 0;
 
-        for (intE k = outDegree[i] - 1,
-                  last_non_deleted_index = outDegree[i] - 1;
-             k >= 0; k--) {
-          if (currOutEdges[k] == maxValue) {
-            currOutEdges[k] = currOutEdges[last_non_deleted_index];
+      for (intE k = outDegree[v] - 1, last_non_deleted_index = outDegree[v] - 1;
+           k >= 0; k--) {
+        if (currOutEdges[k] == maxValue) {
+          currOutEdges[k] = currOutEdges[last_non_deleted_index];
 #ifdef EDGEDATA
-            currOutEdgeData[k].del();
-            currOutEdgeData[k] = currOutEdgeData[last_non_deleted_index];
+          currOutEdgeData[k].del();
+          currOutEdgeData[k] = currOutEdgeData[last_non_deleted_index];
 #endif
-            last_non_deleted_index--;
-            total_swapped++;
-          }
-          if (total_swapped == actual_to_delete_count) {
-            break;
-          }
+          last_non_deleted_index--;
+          total_swapped++;
+        }
+        if (total_swapped == actual_to_delete_count) {
+          break;
         }
+      }
 
-        V[i].setOutDegree(outDegree[i] - total_swapped);
-        pbbs::fetch_and_add(&numberOfSuccessfulDeletions, total_swapped);
+      V[i].setOutDegree(outDegree[v] - total_swapped);
+      pbbs::fetch_and_add(&numberOfSuccessfulDeletions, total_swapped);
 
-        vector<uintV> &inEdgesToDelete = currentEdgesToDelete->inEdgesToDelete;
-        to_delete_count = inEdgesToDelete.size();
-        actual_to_delete_count = 0;
-        for (intE i = 0; i < to_delete_count; i++) {
-          if (inEdgesToDelete[i] != maxValue) {
-            actual_to_delete_count++;
-          }
+      uintV *inEdgesToDelete =
+          deletionsData.inNeighbors + deletionsData.inOffsets[v];
+      to_delete_count = deletionsData.inDeletionCount(v);
+      actual_to_delete_count = 0;
+      for (intE i = 0; i < to_delete_count; i++) {
+        if (inEdgesToDelete[i] != maxValue) {
+          actual_to_delete_count++;
         }
+      }
 
-        total_swapped = 0;
+      total_swapped = 0;
 
-        for (intE k = inDegree[i] - 1, last_non_deleted_index = inDegree[i] - 1;
-             k >= 0; k--) {
-          if (currInEdges[k] == maxValue) {
-            currInEdges[k] = currInEdges[last_non_deleted_index];
+      for (intE k = inDegree[v] - 1, last_non_deleted_index = inDegree[v] - 1;
+           k >= 0; k--) {
+        if (currInEdges[k] == maxValue) {
+          currInEdges[k] = currInEdges[last_non_deleted_index];
 #ifdef EDGEDATA
-            currInEdgeData[k].del();
-            currInEdgeData[k] = currInEdgeData[last_non_deleted_index];
+          currInEdgeData[k].del();
+          currInEdgeData[k] = currInEdgeData[last_non_deleted_index];
 #endif
-            last_non_deleted_index--;
-            total_swapped++;
-          }
-          if (total_swapped == actual_to_delete_count) {
-            break;
-          }
+          last_non_deleted_index--;
+          total_swapped++;
+        }
+        if (total_swapped == actual_to_delete_count) {
+          break;
         }
-        V[i].setInDegree(inDegree[i] - total_swapped);
       }
-    }
+      V[i].setInDegree(inDegree[v] - total_swapped);
+    });
     intE edgeArrayIndex = 0;
 
-    for (uintV i = 0; i < n; i++) {
-      if (deletionsData.updatedVertices[i] == 1) {
-        edgesToDelete *currentEdgesToDelete =
-            &deletionsData.getEdgeDeletionData(i);
-        vector<uintV> &outEdgesToDelete =
-            currentEdgesToDelete->outEdgesToDelete;
-#ifdef EDGEDATA
-        vector<EdgeData *> &outEdgeDataToDelete =
-            currentEdgesToDelete->outEdgeDataToDelete;
-#endif
-        for (uintE j = 0; j < outEdgesToDelete.size(); j++) {
-          if (outEdgesToDelete[j] != maxValue) {
-            intE edIndex = edgeArrayIndex++;
-            ED[edIndex].source = i;
-            ED[edIndex].destination = outEdgesToDelete[j];
+    for (long v = 0; v < numberOfVertices; v++) {
+      uintV i = deletionsData.vertices[v];
+      long outOffset = deletionsData.outOffsets[v];
+      for (uintE j = 0; j < deletionsData.outDeletionCount(v); j++) {
+        uintV outNgh = deletionsData.outNeighbors[outOffset + j];
+        if (outNgh != maxValue) {
+          intE edIndex = edgeArrayIndex++;
+          ED[edIndex].source = i;
+          ED[edIndex].destination = outNgh;
 #ifdef EDGEDATA
-            new (edgeDataWeight + edIndex) EdgeData();
-            ED[edIndex].edgeData = &edgeDataWeight[edIndex];
-            ED[edIndex].edgeData->setEdgeDataFromPtr(outEdgeDataToDelete[j]);
+          new (edgeDataWeight + edIndex) EdgeData();
+          ED[edIndex].edgeData = &edgeDataWeight[edIndex];
+          ED[edIndex].edgeData->setEdgeDataFromPtr(
+              deletionsData.outEdgeData[outOffset + j]);
 #endif
-          } else {
-            if (debugFlag) {
-              cerr << "INVALID: " << i << "\t" << outEdgesToDelete[j] << "\n";
-            }
+        } else {
+          if (debugFlag) {
+            cerr << "INVALID: " << i << "\t" << outNgh << "\n";
           }
         }
       }
@@ -1102,6 +1191,7 @@ public:
 
     free(outDegree);
     free(inDegree);
+    free(matched);
     uintE newSize = m - numberOfSuccessfulDeletions;
     m = newSize;
 #ifdef EDGEDATA
@@ -1118,15 +1208,13 @@ public:
       for (uintV i = 0; i < n; i++)
         V[i].del();
     } else {
-      parallel_for(uintV i = 0; i < n; i++) { 
 #ifdef EDGEDATA
-        parallel_for(intE j = 0; j < V[i].getOutDegree(); j++) {
+      parallel_for(0, n, [&](uintV i) {
+        parallel_for(0, V[i].getOutDegree(), [&](intE j) {
           outEdgeData[i][j].del();
-        }
-        free(outEdgeData[i]);
+        });
+      });
 #endif
-        free(outEdges[i]); 
-      }
       free(outEdges);
 #ifdef EDGEDATA
       free(outEdgeData);
@@ -1137,21 +1225,23 @@ public:
     }
 
     if (inEdges != NULL) {
-      parallel_for(uintV i = 0; i < n; i++) { 
 #ifdef EDGEDATA
-        parallel_for(intE j = 0; j < V[i].getInDegree(); j++) {
+      parallel_for(0, n, [&](uintV i) {
+        parallel_for(0, V[i].getInDegree(), [&](intE j) {
           inEdgeData[i][j].del();
-        }
-        free(inEdgeData[i]);
+        });
+      });
 #endif
-        free(inEdges[i]);
-      }
       free(inEdges);
 #ifdef EDGEDATA
       free(inEdgeData);
 #endif
     }
     free(V);
+    edgeSlabs.del();
+#ifdef EDGEDATA
+    edgeDataSlabs.del();
+#endif
 
     if (inEdgesArraySize != NULL) {
       free(inEdgesArraySize);
@@ -1174,6 +1264,7 @@ template <class vertex> struct graph {
   bool symmetric;
   uintE *flags;
   Deletable *D;
+  VertexOrder order;
 
   graph(vertex *_V, uintV _n, uintE _m, Deletable *_D)
       : V(_V), n(_n), m(_m), D(_D), flags(NULL), transposed(0), symmetric(0) {}
@@ -1185,6 +1276,7 @@ template <class vertex> struct graph {
   void del() {
     if (flags != NULL)
       free(flags);
+    order.del();
     D->del();
     // free(D);
     delete D;
@@ -1195,6 +1287,29 @@ template <class vertex> struct graph {
     D->setSymmetric(flag);
   }
 
+  void setCapacityPolicy(const AdjacencyCapacityPolicy &policy) {
+    D->setCapacityPolicy(policy);
+  }
+
+  void printMemoryUsage() { D->printMemoryUsage(); }
+
+  // Relabels the vertices in the given order (see vertexOrder.h). Vertex
+  // ids read afterwards must go through order.internalId(), and ids written
+  // out through order.originalId().
+  void reorder(VertexOrderType type) {
+    timer reorderTimer;
+    reorderTimer.start();
+    order.type = type;
+    order.create(n, [&](uintV i) -> uintE {
+      return symmetric ? V[i].getOutDegree()
+                       : V[i].getOutDegree() + V[i].getInDegree();
+    });
+    if (order.isRelabeled()) {
+      V = (vertex *)D->relabel(order.internalIds, order.originalIds);
+      cout << "Reorder time : " << reorderTimer.next() << "\n";
+    }
+  }
+
   bool isSymmetric() { return symmetric; }
 
   void addVertices(uintV maxVertex) {
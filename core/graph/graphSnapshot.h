@@ -0,0 +1,136 @@
+// Copyright (c) 2020 Mugilan Mariappan, Joanna Che and Keval Vora.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef GRAPH_SNAPSHOT_H
+#define GRAPH_SNAPSHOT_H
+
+// Binary graph snapshot. Written by tools/converters/AdjToSnapshotConverter
+// and memory-mapped by readGraph(). The file starts with a
+// GraphSnapshotHeader, followed by the sections below, each starting at a
+// GRAPH_SNAPSHOT_ALIGNMENT byte boundary:
+//
+//   out offsets   : uint64_t[n + 1]
+//   out edges     : vertex ids, vertex_width bytes each [m]
+//   out edge data : edge_data_width bytes each [m] (weighted graphs only)
+//   in offsets    : uint64_t[n + 1] (directed graphs only)
+//   in edges      : vertex ids, vertex_width bytes each [m]
+//   in edge data  : edge_data_width bytes each [m]
+//
+// Integers are stored in host byte order. Each edge data entry is the raw
+// EdgeData value of the application (see edgeDataType.h), so edge_data_width
+// is sizeof(EdgeData) and a weighted snapshot can only be loaded by an
+// application with the same edge data type.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#define GRAPH_SNAPSHOT_MAGIC "GBSNAPSH"
+#define GRAPH_SNAPSHOT_MAGIC_SIZE 8
+#define GRAPH_SNAPSHOT_VERSION 2
+#define GRAPH_SNAPSHOT_ALIGNMENT 64
+
+struct GraphSnapshotHeader {
+  char magic[GRAPH_SNAPSHOT_MAGIC_SIZE];
+  uint32_t version;
+  uint32_t vertex_width;    // 4 or 8
+  uint32_t edge_data_width; // 0 for unweighted graphs
+  uint32_t generation;      // batch of the checkpoint holding it, else 0
+  uint64_t n;
+  uint64_t m;
+  // Byte position of each section in the file. 0 if the section is absent.
+  uint64_t out_offsets_pos;
+  uint64_t out_edges_pos;
+  uint64_t out_edge_data_pos;
+  uint64_t in_offsets_pos;
+  uint64_t in_edges_pos;
+  uint64_t in_edge_data_pos;
+
+  GraphSnapshotHeader() { memset(this, 0, sizeof(GraphSnapshotHeader)); }
+
+  bool isValid() const {
+    return memcmp(magic, GRAPH_SNAPSHOT_MAGIC, GRAPH_SNAPSHOT_MAGIC_SIZE) ==
+               0 &&
+           version == GRAPH_SNAPSHOT_VERSION &&
+           (vertex_width == 4 || vertex_width == 8);
+  }
+
+  bool hasInEdges() const { return in_offsets_pos != 0; }
+
+  bool hasEdgeData() const { return edge_data_width != 0; }
+
+  // Assigns the section positions from n, m and the widths. Returns the size
+  // of the file.
+  uint64_t layout(bool inEdges) {
+    uint64_t pos = alignPos(sizeof(GraphSnapshotHeader));
+    out_offsets_pos = pos;
+    pos = alignPos(pos + (n + 1) * sizeof(uint64_t));
+    out_edges_pos = pos;
+    pos = alignPos(pos + m * vertex_width);
+    out_edge_data_pos = 0;
+    if (edge_data_width > 0) {
+      out_edge_data_pos = pos;
+      pos = alignPos(pos + m * edge_data_width);
+    }
+    in_offsets_pos = in_edges_pos = in_edge_data_pos = 0;
+    if (inEdges) {
+      in_offsets_pos = pos;
+      pos = alignPos(pos + (n + 1) * sizeof(uint64_t));
+      in_edges_pos = pos;
+      pos = alignPos(pos + m * vertex_width);
+      if (edge_data_width > 0) {
+        in_edge_data_pos = pos;
+        pos = alignPos(pos + m * edge_data_width);
+      }
+    }
+    return pos;
+  }
+
+  static uint64_t alignPos(uint64_t pos) {
+    return (pos + GRAPH_SNAPSHOT_ALIGNMENT - 1) /
+           GRAPH_SNAPSHOT_ALIGNMENT * GRAPH_SNAPSHOT_ALIGNMENT;
+  }
+};
+
+// Returns true if fileName starts with the snapshot magic.
+inline bool isGraphSnapshot(const char *fileName) {
+  char magic[GRAPH_SNAPSHOT_MAGIC_SIZE];
+  FILE *f = fopen(fileName, "rb");
+  if (f == NULL)
+    return false;
+  size_t read = fread(magic, 1, GRAPH_SNAPSHOT_MAGIC_SIZE, f);
+  fclose(f);
+  return read == GRAPH_SNAPSHOT_MAGIC_SIZE &&
+         memcmp(magic, GRAPH_SNAPSHOT_MAGIC, GRAPH_SNAPSHOT_MAGIC_SIZE) == 0;
+}
+
+// Reads the header of a snapshot. Returns false if fileName is not a snapshot.
+inline bool readGraphSnapshotHeader(const char *fileName,
+                                    GraphSnapshotHeader &header) {
+  FILE *f = fopen(fileName, "rb");
+  if (f == NULL)
+    return false;
+  size_t read = fread(&header, sizeof(GraphSnapshotHeader), 1, f);
+  fclose(f);
+  return read == 1 && header.isValid();
+}
+
+#endif
@@ -0,0 +1,249 @@
+// Copyright (c) 2020 Mugilan Mariappan, Joanna Che and Keval Vora.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+// Owns the per-vertex adjacency arrays of AdjacencyRep. Arrays are handed
+// out for a whole batch of vertices at once:
+//
+//   allocate()   : one slab holding an exact-size array for every vertex
+//                  (used when the graph is loaded).
+//   reallocate() : moves the arrays that need to grow to blocks of the
+//                  capacities chosen by an AdjacencyCapacityPolicy. Blocks are
+//                  taken from the free lists first, the rest are carved from a
+//                  single new slab.
+//
+// Free blocks are kept in lists by size class: list c holds the blocks with
+// a capacity in [2^c, 2^(c+1)). A request for r elements takes a block from
+// the list of the smallest power of 2 >= r, and the unused end of the block
+// goes back to the free lists. The arrays that were moved are reclaimed once
+// the whole batch has been copied. Slabs are only freed by del(), so the
+// memory of the graph never shrinks.
+
+#include "../common/ligraUtils.h"
+#include "../common/parallel.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+enum CapacityPolicyType {
+  exact_capacity,       // degree
+  slack_capacity,       // degree + slack
+  doubling_capacity,    // smallest power of 2 >= degree
+  proportional_capacity // degree * (1 + growth)
+};
+
+// Capacity given to an adjacency array when it needs to grow (-adjacencyPolicy)
+struct AdjacencyCapacityPolicy {
+  CapacityPolicyType type;
+  long slack;
+  double growth;
+
+  AdjacencyCapacityPolicy()
+      : type(doubling_capacity), slack(10), growth(0.5) {}
+
+  // Returns false if name is not a policy
+  bool setType(const string &name) {
+    if (name == "exact") {
+      type = exact_capacity;
+    } else if (name == "slack") {
+      type = slack_capacity;
+    } else if (name == "doubling") {
+      type = doubling_capacity;
+    } else if (name == "proportional") {
+      type = proportional_capacity;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  string name() const {
+    switch (type) {
+    case exact_capacity:
+      return "exact";
+    case slack_capacity:
+      return "slack " + to_string(slack);
+    case doubling_capacity:
+      return "doubling";
+    default:
+      return "proportional " + to_string(growth);
+    }
+  }
+
+  uintE capacity(uintE count) const {
+    switch (type) {
+    case exact_capacity:
+      return count;
+    case slack_capacity:
+      return count + slack;
+    case doubling_capacity: {
+      uintE capacity = 1;
+      while (capacity < count) {
+        capacity <<= 1;
+      }
+      return capacity;
+    }
+    default:
+      return max(count, (uintE)(count * (1 + growth)));
+    }
+  }
+};
+
+template <class T> class SlabAllocator {
+  static const int NUM_SIZE_CLASSES = 64;
+
+  struct FreeBlock {
+    T *block;
+    size_t capacity;
+  };
+
+  vector<T *> slabs;
+  vector<FreeBlock> free_blocks[NUM_SIZE_CLASSES];
+  size_t allocated_elements = 0;
+  size_t free_elements = 0;
+
+  static int floorLog2(size_t x) {
+    int c = 0;
+    while ((x >> (c + 1)) != 0) {
+      c++;
+    }
+    return c;
+  }
+
+  static int ceilLog2(size_t x) {
+    int c = floorLog2(x);
+    return ((size_t(1) << c) < x) ? c + 1 : c;
+  }
+
+  T *newSlab(size_t count) {
+    T *slab = newA(T, count);
+    slabs.push_back(slab);
+    allocated_elements += count;
+    return slab;
+  }
+
+  void reclaim(T *block, size_t capacity) {
+    if (capacity > 0) {
+      free_blocks[floorLog2(capacity)].push_back({block, capacity});
+      free_elements += capacity;
+    }
+  }
+
+  // A free block of at least count elements, or NULL. The rest of the block
+  // is reclaimed.
+  T *reuse(size_t count) {
+    for (int c = ceilLog2(count); c < NUM_SIZE_CLASSES; c++) {
+      if (!free_blocks[c].empty()) {
+        FreeBlock free_block = free_blocks[c].back();
+        free_blocks[c].pop_back();
+        free_elements -= free_block.capacity;
+        reclaim(free_block.block + count, free_block.capacity - count);
+        return free_block.block;
+      }
+    }
+    return NULL;
+  }
+
+public:
+  size_t allocatedBytes() const { return allocated_elements * sizeof(T); }
+  size_t freeBytes() const { return free_elements * sizeof(T); }
+
+  // blocks[i] = an array of size(i) elements, for i in [0, n).
+  template <class F> void allocate(long n, T **blocks, F size) {
+    size_t *offsets = newA(size_t, n);
+    parallel_for(0, n, [&](long i) { offsets[i] = size(i); });
+    size_t total = sequence::plusScan(offsets, offsets, n);
+    T *slab = newSlab(total);
+    parallel_for(0, n, [&](long i) { blocks[i] = slab + offsets[i]; });
+    free(offsets);
+  }
+
+  // For each i with new_capacity[i] > capacity[i], moves the first used(i)
+  // elements of blocks[i] to a block of new_capacity[i] elements. capacity
+  // is left to the caller since the same capacities can describe arrays of
+  // several allocators.
+  template <class F>
+  void reallocate(long n, T **blocks, const uintE *capacity,
+                  const uintE *new_capacity, F used) {
+    bool *grows = newA(bool, n);
+    parallel_for(0, n,
+                 [&](long i) { grows[i] = new_capacity[i] > capacity[i]; });
+    _seq<long> grown = sequence::packIndex<long>(grows, n);
+    free(grows);
+    if (grown.n == 0) {
+      grown.del();
+      return;
+    }
+
+    // Reuse free blocks, and carve the others from one slab
+    T **new_blocks = newA(T *, grown.n);
+    size_t *slab_offset = newA(size_t, grown.n);
+    size_t carved = 0;
+    for (long j = 0; j < grown.n; j++) {
+      size_t count = new_capacity[grown.A[j]];
+      new_blocks[j] = reuse(count);
+      if (new_blocks[j] == NULL) {
+        slab_offset[j] = carved;
+        carved += count;
+      }
+    }
+    T *slab = carved ? newSlab(carved) : NULL;
+
+    parallel_for(0, grown.n, [&](long j) {
+      long i = grown.A[j];
+      if (new_blocks[j] == NULL) {
+        new_blocks[j] = slab + slab_offset[j];
+      }
+      size_t count = used(i);
+      if (count > 0) {
+        memcpy((void *)new_blocks[j], (void *)blocks[i], count * sizeof(T));
+      }
+    });
+
+    for (long j = 0; j < grown.n; j++) {
+      long i = grown.A[j];
+      reclaim(blocks[i], capacity[i]);
+      blocks[i] = new_blocks[j];
+    }
+    free(new_blocks);
+    free(slab_offset);
+    grown.del();
+  }
+
+  void del() {
+    for (T *slab : slabs) {
+      free(slab);
+    }
+    slabs.clear();
+    for (int c = 0; c < NUM_SIZE_CLASSES; c++) {
+      free_blocks[c].clear();
+    }
+    allocated_elements = 0;
+    free_elements = 0;
+  }
+};
+
+#endif
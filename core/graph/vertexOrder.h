@@ -0,0 +1,123 @@
+// Copyright (c) 2020 Mugilan Mariappan, Joanna Che and Keval Vora.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VERTEX_ORDER_H
+#define VERTEX_ORDER_H
+
+// Load-time relabeling of the vertices (-reorder), so that the vertices that
+// are accessed together get nearby ids. Vertex v of the input is vertex
+// internalId(v) of the graph, and the stream is relabeled the same way.
+// Vertices added by the stream past the relabeled range keep their id.
+//
+//   degree : by decreasing degree.
+//   hub    : the vertices with more than the average degree first, then the
+//            others. Each group keeps the input order (hub clustering).
+
+#include "../common/ligraUtils.h"
+#include "../common/parallel.h"
+#include "../common/quickSort.h"
+#include <string>
+
+using namespace std;
+
+enum VertexOrderType { input_order, degree_order, hub_order };
+
+struct VertexOrder {
+  VertexOrderType type = input_order;
+  uintV n = 0;
+  uintV *internalIds = NULL;
+  uintV *originalIds = NULL;
+
+  // Returns false if name is not an order
+  bool setType(const string &name) {
+    if (name == "none") {
+      type = input_order;
+    } else if (name == "degree") {
+      type = degree_order;
+    } else if (name == "hub") {
+      type = hub_order;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  bool isRelabeled() const { return n > 0; }
+
+  inline uintV internalId(uintV v) const {
+    return (v < n) ? internalIds[v] : v;
+  }
+
+  inline uintV originalId(uintV v) const {
+    return (v < n) ? originalIds[v] : v;
+  }
+
+  // Relabels the vertices [0, _n) by type, from their degree(i)
+  template <class F> void create(uintV _n, F degree) {
+    if (type == input_order || _n == 0) {
+      return;
+    }
+    n = _n;
+    originalIds = newA(uintV, n);
+    internalIds = newA(uintV, n);
+    uintE *degrees = newA(uintE, n);
+    parallel_for(0, n, [&](uintV i) {
+      originalIds[i] = i;
+      degrees[i] = degree(i);
+    });
+
+    if (type == degree_order) {
+      // Ties keep the input order
+      quickSort(originalIds, (long)n, [&](uintV a, uintV b) {
+        return (degrees[a] > degrees[b]) || (degrees[a] == degrees[b] && a < b);
+      });
+    } else {
+      double average = sequence::reduce<double>(
+                           (long)0, (long)n, addF<double>(),
+                           [&](long i) -> double { return degrees[i]; }) /
+                       n;
+      bool *hub = newA(bool, n);
+      parallel_for(0, n, [&](uintV i) { hub[i] = degrees[i] > average; });
+      _seq<long> hubs = sequence::packIndex<long>(hub, (long)n);
+      parallel_for(0, n, [&](uintV i) { hub[i] = !hub[i]; });
+      _seq<long> others = sequence::packIndex<long>(hub, (long)n);
+      parallel_for(0, hubs.n, [&](long i) { originalIds[i] = hubs.A[i]; });
+      parallel_for(0, others.n,
+                   [&](long i) { originalIds[hubs.n + i] = others.A[i]; });
+      hubs.del();
+      others.del();
+      free(hub);
+    }
+
+    parallel_for(0, n, [&](uintV i) { internalIds[originalIds[i]] = i; });
+    free(degrees);
+  }
+
+  void del() {
+    if (n > 0) {
+      free(internalIds);
+      free(originalIds);
+    }
+    n = 0;
+  }
+};
+
+#endif
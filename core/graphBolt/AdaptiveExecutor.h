@@ -24,7 +24,6 @@
 
 #include "../common/utils.h"
 #include "../graph/graph.h"
-#include "../graph/vertexSubset.h"
 #include <limits>
 
 class AdaptiveExecutor {
@@ -96,14 +95,15 @@ public:
     }
   }
 
-  template <class vertex>
+  template <class vertex, class Flags>
   inline void updateEdgesProcessed(int iter, graph<vertex> &t_graph,
-                                   vertexSubset &frontier) {
-    long edges_to_process =
-        sequence::plusReduceDegree(t_graph.V, frontier.d, (long)t_graph.n);
+                                   const Flags &frontier) {
+    long edges_to_process = frontier.outDegreeSum(t_graph.V);
     active_edges[iter] = edges_to_process;
   }
 
+  inline long activeEdges(int iter) const { return active_edges[iter]; }
+
   inline void updateEdgeMapTime(int iter, double t_edge_map_time) {
     edge_map_time[iter] = t_edge_map_time;
   }
@@ -0,0 +1,276 @@
+// Copyright (c) 2020 Mugilan Mariappan, Joanna Che and Keval Vora.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __DEPENDENCY_HISTORY_H__
+#define __DEPENDENCY_HISTORY_H__
+
+#include "../common/utils.h"
+#include <cstring>
+
+// The value of every vertex at every iteration of the computation, used for
+// the aggregation values and the vertex values of the GraphBolt engine.
+//
+// In dense mode, each iteration is an array of n values. In sparse mode
+// (-sparseHistory), a vertex only records the iterations in which its value
+// differs from the previous iteration, and a lookup returns the value of the
+// last recorded iteration at or before the requested one. This saves memory
+// when most vertices converge early or when the values are large (as in CF).
+//
+// Values are compared and moved bytewise, so T must be trivially copyable.
+// Different vertices can be written in parallel, but a vertex must not be
+// read while it is being written.
+template <class T> class DependencyHistory {
+public:
+  struct Entry {
+    T value;
+    int iteration;
+  };
+
+  struct VertexHistory {
+    Entry *entries;
+    int size;
+    int capacity;
+  };
+
+  // Read-only view of an iteration, so that history[iter][v] can be used.
+  class Iteration {
+    const DependencyHistory &history;
+    int iter;
+
+  public:
+    Iteration(const DependencyHistory &_history, int _iter)
+        : history(_history), iter(_iter) {}
+    inline const T &operator[](long v) const { return history.get(v, iter); }
+  };
+
+  int history_iterations;
+  long n;
+  bool sparse;
+  // Writes to iteration i keep the value of iteration i + 1 unchanged if
+  // i < last_iteration. Later iterations are recomputed before being read.
+  int last_iteration;
+
+  T **values;               // dense
+  VertexHistory *vertices;  // sparse
+
+  DependencyHistory()
+      : history_iterations(0), n(0), sparse(false), last_iteration(0),
+        values(nullptr), vertices(nullptr) {}
+
+  void create(int _history_iterations, long _n, bool _sparse) {
+    history_iterations = _history_iterations;
+    n = _n;
+    sparse = _sparse;
+    last_iteration = 0;
+    if (sparse) {
+      vertices = newA(VertexHistory, n);
+      parallel_for(0, n, [&](long v) {
+        vertices[v].entries = nullptr;
+        vertices[v].size = 0;
+        vertices[v].capacity = 0;
+      });
+    } else {
+      values = newA(T *, history_iterations);
+      for (int i = 0; i < history_iterations; i++) {
+        values[i] = newA(T, n);
+      }
+    }
+  }
+
+  // New vertices have to be initialized with init()
+  void resize(long n_new) {
+    if (sparse) {
+      vertices = renewA(VertexHistory, vertices, n_new);
+      parallel_for(n, n_new, [&](long v) {
+        vertices[v].entries = nullptr;
+        vertices[v].size = 0;
+        vertices[v].capacity = 0;
+      });
+    } else {
+      for (int i = 0; i < history_iterations; i++) {
+        values[i] = renewA(T, values[i], n_new);
+      }
+    }
+    n = n_new;
+  }
+
+  void del() {
+    if (sparse) {
+      parallel_for(0, n, [&](long v) {
+        if (vertices[v].entries != nullptr)
+          free(vertices[v].entries);
+      });
+      deleteA(vertices);
+    } else {
+      for (int i = 0; i < history_iterations; i++) {
+        deleteA(values[i]);
+      }
+      deleteA(values);
+    }
+  }
+
+  void setLastIteration(int iter) { last_iteration = iter; }
+
+  inline Iteration operator[](int iter) const { return Iteration(*this, iter); }
+
+  inline const T &get(long v, int iter) const {
+    if (!sparse) {
+      return values[iter][v];
+    }
+    const VertexHistory &h = vertices[v];
+    return h.entries[findEntry(h, iter)].value;
+  }
+
+  // Sets the value of v to value in all iterations
+  void init(long v, const T &value) {
+    if (!sparse) {
+      for (int i = 0; i < history_iterations; i++) {
+        values[i][v] = value;
+      }
+      return;
+    }
+    VertexHistory &h = vertices[v];
+    if (h.capacity == 0) {
+      h.entries = newA(Entry, 1);
+      h.capacity = 1;
+    }
+    memcpy(&h.entries[0].value, &value, sizeof(T));
+    h.entries[0].iteration = 0;
+    h.size = 1;
+  }
+
+  // Sets the value of v in iteration iter. value must not refer to an entry
+  // of this history (see copyPrevious()).
+  void set(long v, int iter, const T &value) {
+    if (!sparse) {
+      values[iter][v] = value;
+      return;
+    }
+    VertexHistory &h = vertices[v];
+    int i = findEntry(h, iter);
+    if (iter < last_iteration &&
+        (i + 1 == h.size || h.entries[i + 1].iteration != iter + 1) &&
+        !equal(h.entries[i].value, value)) {
+      // iter + 1 shares the entry of iter. Record it before changing iter.
+      insertEntry(h, i + 1, h.entries[i].value, iter + 1);
+    }
+    if (h.entries[i].iteration == iter) {
+      if (i > 0 && equal(h.entries[i - 1].value, value)) {
+        eraseEntry(h, i);
+      } else {
+        memcpy(&h.entries[i].value, &value, sizeof(T));
+      }
+    } else if (!equal(h.entries[i].value, value)) {
+      insertEntry(h, i + 1, value, iter);
+    }
+  }
+
+  // Sets the value of v in iteration iter to its value in iteration iter - 1
+  void copyPrevious(long v, int iter) {
+    if (!sparse) {
+      values[iter][v] = values[iter - 1][v];
+      return;
+    }
+    VertexHistory &h = vertices[v];
+    int i = findEntry(h, iter);
+    if (h.entries[i].iteration != iter) {
+      return;
+    }
+    if (iter < last_iteration &&
+        (i + 1 == h.size || h.entries[i + 1].iteration != iter + 1)) {
+      // iter + 1 shares the entry of iter. It now only holds iter + 1.
+      h.entries[i].iteration = iter + 1;
+    } else {
+      eraseEntry(h, i);
+    }
+  }
+
+  // Iteration iter (and the iterations after it) of v take the value of
+  // iteration iter - 1. The values after iter are recomputed later.
+  void discardFrom(long v, int iter) {
+    if (!sparse) {
+      values[iter][v] = values[iter - 1][v];
+      return;
+    }
+    VertexHistory &h = vertices[v];
+    while (h.size > 1 && h.entries[h.size - 1].iteration >= iter) {
+      h.size--;
+    }
+  }
+
+  // Copies iteration iter of all vertices to / from an array of n values
+  void getIteration(int iter, T *A) const {
+    parallel_for(0, n, [&](long v) { A[v] = get(v, iter); });
+  }
+  void setIteration(int iter, const T *A) {
+    parallel_for(0, n, [&](long v) { set(v, iter, A[v]); });
+  }
+
+  // Number of values stored, across all iterations
+  long size() const {
+    if (!sparse) {
+      return (long)history_iterations * n;
+    }
+    return sequence::reduce<long>((long)0, n, addF<long>(),
+                                  [&](long v) -> long {
+                                    return vertices[v].size;
+                                  });
+  }
+
+private:
+  // Index of the last entry recorded at or before iter
+  static inline int findEntry(const VertexHistory &h, int iter) {
+    int i = h.size - 1;
+    while (i > 0 && h.entries[i].iteration > iter) {
+      i--;
+    }
+    return i;
+  }
+
+  static inline bool equal(const T &a, const T &b) {
+    return memcmp(&a, &b, sizeof(T)) == 0;
+  }
+
+  // value may be the value of an entry before index
+  void insertEntry(VertexHistory &h, int index, const T &value, int iter) {
+    long offset = (const char *)&value - (const char *)h.entries;
+    bool in_entries = offset >= 0 && offset < h.size * (long)sizeof(Entry);
+    if (h.size == h.capacity) {
+      h.capacity = std::min(2 * h.capacity, history_iterations);
+      h.entries = renewA(Entry, h.entries, h.capacity);
+    }
+    const T *source = in_entries ? (const T *)((char *)h.entries + offset)
+                                 : &value;
+    memmove(&h.entries[index + 1], &h.entries[index],
+            (h.size - index) * sizeof(Entry));
+    memcpy(&h.entries[index].value, source, sizeof(T));
+    h.entries[index].iteration = iter;
+    h.size++;
+  }
+
+  static void eraseEntry(VertexHistory &h, int index) {
+    memmove(&h.entries[index], &h.entries[index + 1],
+            (h.size - index - 1) * sizeof(Entry));
+    h.size--;
+  }
+};
+
+#endif
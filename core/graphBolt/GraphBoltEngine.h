@@ -24,6 +24,9 @@
 
 #include "../common/utils.h"
 #include "AdaptiveExecutor.h"
+#include "DependencyHistory.h"
+#include "VertexFlags.h"
+#include "checkpoint.h"
 #include "ingestor.h"
 #include <vector>
 #include <cassert>
@@ -211,6 +214,8 @@ inline bool edgeFunction(const uintV &u, const uintV &v,
 // recomputed in the first iteration. For example, in COEM, if the sum of
 // inWeights of a vertex changes, then computeFuntion() should be
 // called for that vertex in the first iteration.
+// Both flags can only be set to true, as other updates may have already set
+// them.
 template <class GlobalInfoType>
 inline void hasSourceChangedByUpdate(const uintV &v, UpdateType update_type,
                                      bool &activateInCurrentIteration,
@@ -246,9 +251,10 @@ void printAdditionalData(ofstream &output_file, const uintV &v,
 // Helper function for printing the dependency data - Useful for debugging
 template <class AggregationValueType, class VertexValueType,
           class GlobalInfoType>
-void printHistory(const uintV &v, AggregationValueType **agg_values,
-                  VertexValueType **vertex_values, GlobalInfoType &info,
-                  int history_iterations);
+void printHistory(const uintV &v,
+                  DependencyHistory<AggregationValueType> &agg_values,
+                  DependencyHistory<VertexValueType> &vertex_values,
+                  GlobalInfoType &info, int history_iterations);
 
 // ======================================================================
 // GRAPHBOLT ENGINE
@@ -267,11 +273,25 @@ public:
   int converged_iteration;
   bool use_lock;
 
-  RWLock *vertex_locks;
+  StripedLock vertex_locks;
+
+  // Per-worker partial deltas of the vertices with the highest in-degrees
+  // (-localAggregation). local_aggregation_slot[v] is the slot of v, or -1.
+  long local_aggregation_size;
+  int local_aggregation_workers;
+  long *local_aggregation_slot;
+  uintV *local_aggregation_vertices;
+  AggregationValueType *local_aggregation_values;
+  bool *local_aggregation_touched;
+
+  // The traditional computation gathers along in-edges instead of pushing
+  // when the active edges exceed m / pull_threshold (-pullThreshold)
+  long pull_threshold;
 
   // Dependency information
-  AggregationValueType **aggregation_values;
-  VertexValueType **vertex_values;
+  bool sparse_history;
+  DependencyHistory<AggregationValueType> aggregation_values;
+  DependencyHistory<VertexValueType> vertex_values;
 
   // Current graph
   long n;
@@ -289,13 +309,13 @@ public:
   VertexValueType *vertex_value_old_curr;
   VertexValueType *vertex_value_old_prev;
 
-  // TODO : Replace with more bitmaps
-  bool *all;
-  bool *frontier_curr;
-  bool *frontier_next;
-  bool *changed;
-  bool *retract;
-  bool *propagate;
+  // Bitsets with -DBITSET_FRONTIERS (see VertexFlags.h)
+  VertexFlags all;
+  VertexFlags frontier_curr;
+  VertexFlags frontier_next;
+  VertexFlags changed;
+  VertexFlags retract;
+  VertexFlags propagate;
 
   // Stream Ingestor
   Ingestor<vertex> ingestor;
@@ -305,12 +325,19 @@ public:
   AdaptiveExecutor adaptive_executor;
   bool ae_enabled;
 
+  // Checkpoints of the dependency data
+  string checkpoint_path;
+  long checkpoint_interval;
+
   // ======================================================================
   // CONSTRUCTOR / INIT
   // ======================================================================
+  // Applications whose removeFromAggregation() is the inverse of
+  // addToAggregation() (sums) pass local_aggregation = true to accept
+  // -localAggregation. See createLocalAggregation().
   GraphBoltEngine(graph<vertex> &_my_graph, int _max_iter,
                   GlobalInfoType &_global_info, bool _use_lock,
-                  commandLine _config)
+                  commandLine _config, bool local_aggregation = false)
       : my_graph(_my_graph), max_iterations(_max_iter),
         history_iterations(_max_iter), converged_iteration(0),
         global_info(_global_info), use_lock(_use_lock), global_info_old(),
@@ -319,11 +346,23 @@ public:
     n = my_graph.n;
     n_old = 0;
     if (use_lock) {
-      cout << "Using locks for edge operations\n";
       createLocks();
-      initLocks();
+      cout << "Using locks for edge operations (" << vertex_locks.size()
+           << " stripes)\n";
     }
     ae_enabled = config.getOptionValue("-ae");
+    sparse_history = config.getOptionValue("-sparseHistory");
+    checkpoint_path = config.getOptionValue("-checkpointPath", "");
+    checkpoint_interval =
+        max(1L, config.getOptionLongValue("-checkpointInterval", 1));
+    local_aggregation_size =
+        max(0L, config.getOptionLongValue("-localAggregation", 0));
+    if (local_aggregation_size > 0 && !local_aggregation) {
+      cout << "WARNING: -localAggregation is not supported by this "
+              "application. Ignoring it\n";
+      local_aggregation_size = 0;
+    }
+    pull_threshold = max(0L, config.getOptionLongValue("-pullThreshold", 0));
   }
 
   void init() {
@@ -331,18 +370,20 @@ public:
     createDependencyData();
     createTemporaryStructures();
     createVertexSubsets();
+    createLocalAggregation();
     cout << "Initializing dependency structure ....\n";
     initVertexSubsets();
     initTemporaryStructures();
     initDependencyData();
+    initLocalAggregation();
   }
 
   ~GraphBoltEngine() {
     freeDependencyData();
     freeVertexSubsets();
+    freeLocalAggregation();
     if (use_lock) {
-      destroyLocks(n);
-      deleteA(vertex_locks);
+      vertex_locks.del();
     }
     global_info.cleanup();
   }
@@ -350,58 +391,180 @@ public:
   // ======================================================================
   // CREATE / DESTROY LOCKS
   // ======================================================================
-  void createLocks() { vertex_locks = newA(RWLock, n); }
-  void resizeLocks() {
-    vertex_locks = renewA(RWLock, vertex_locks, n);
-    initLocks(n_old, n);
-  }
-  void initLocks() { initLocks(0, n); }
-  void initLocks(long start_index, long end_index) {
-    parallel_for(long i = start_index; i < end_index; i++) {
-      vertex_locks[i].init();
+  // Vertices are hashed to -lockStripes spinlocks, so the locks do not have
+  // to be resized when vertices are added.
+  void createLocks() {
+    vertex_locks.create(
+        max(1L, config.getOptionLongValue("-lockStripes", 4096)));
+  }
+
+  // ======================================================================
+  // PER-WORKER AGGREGATION
+  // ======================================================================
+  // The push loops add to delta[v] with addToAggregationAtomic() (or under a
+  // lock). On power-law graphs, many workers push to the same hub at once
+  // and retry their CAS. Instead, each worker adds to its own partial delta
+  // for the local_aggregation_size vertices with the highest in-degrees,
+  // and mergeLocalAggregation() adds the partial deltas to delta before the
+  // vertex phase. This is the same as accumulating in delta, which starts
+  // at the identity and is added to the aggregation value.
+  void createLocalAggregation() {
+    local_aggregation_size = min(local_aggregation_size, n);
+    if (local_aggregation_size == 0) {
+      return;
+    }
+    local_aggregation_workers = getWorkers();
+    long total = local_aggregation_workers * local_aggregation_size;
+    local_aggregation_slot = newA(long, n);
+    local_aggregation_vertices = newA(uintV, local_aggregation_size);
+    local_aggregation_values = newA(AggregationValueType, total);
+    local_aggregation_touched = newA(bool, total);
+    parallel_for(0, total, [&](long i) {
+      local_aggregation_values[i] =
+          aggregationValueIdentity<AggregationValueType>();
+      local_aggregation_touched[i] = false;
+    });
+  }
+  void freeLocalAggregation() {
+    if (local_aggregation_size == 0) {
+      return;
+    }
+    deleteA(local_aggregation_slot);
+    deleteA(local_aggregation_vertices);
+    deleteA(local_aggregation_values);
+    deleteA(local_aggregation_touched);
+  }
+  // Picks the vertices with the highest in-degrees. The choice is only
+  // updated when vertices are added.
+  void initLocalAggregation() {
+    if (local_aggregation_size == 0) {
+      return;
+    }
+    uintV *ids = newA(uintV, n);
+    parallel_for(0, n, [&](long v) {
+      ids[v] = v;
+      local_aggregation_slot[v] = -1;
+    });
+    quickSort(ids, n, [&](uintV a, uintV b) {
+      return my_graph.V[a].getInDegree() > my_graph.V[b].getInDegree();
+    });
+    parallel_for(0, local_aggregation_size, [&](long i) {
+      local_aggregation_vertices[i] = ids[i];
+      local_aggregation_slot[ids[i]] = i;
+    });
+    deleteA(ids);
+  }
+  void resizeLocalAggregation() {
+    if (local_aggregation_size == 0) {
+      return;
     }
+    local_aggregation_slot = renewA(long, local_aggregation_slot, n);
+    initLocalAggregation();
   }
-  void destroyLocks(long array_size) {
-    parallel_for(long i = 0; i < array_size; i++) { vertex_locks[i].destroy(); }
+
+  // Adds value to delta[v] from a push loop
+  inline void addToDelta(uintV v, const AggregationValueType &value,
+                         GlobalInfoType &info) {
+    long slot = local_aggregation_size ? local_aggregation_slot[v] : -1;
+    if (slot >= 0) {
+      long i = getWorkerId() * local_aggregation_size + slot;
+      addToAggregation(value, local_aggregation_values[i], info);
+      local_aggregation_touched[i] = true;
+    } else if (use_lock) {
+      vertex_locks.lock(v);
+      addToAggregation(value, delta[v], info);
+      vertex_locks.unlock(v);
+    } else {
+      addToAggregationAtomic(value, delta[v], info);
+    }
+  }
+
+  // Removes value from delta[v] from a push loop
+  inline void removeFromDelta(uintV v, const AggregationValueType &value,
+                              GlobalInfoType &info) {
+    long slot = local_aggregation_size ? local_aggregation_slot[v] : -1;
+    if (slot >= 0) {
+      long i = getWorkerId() * local_aggregation_size + slot;
+      removeFromAggregation(value, local_aggregation_values[i], info);
+      local_aggregation_touched[i] = true;
+    } else if (use_lock) {
+      vertex_locks.lock(v);
+      removeFromAggregation(value, delta[v], info);
+      vertex_locks.unlock(v);
+    } else {
+      removeFromAggregationAtomic(value, delta[v], info);
+    }
+  }
+
+  // Must be called after a push loop, before delta is read
+  void mergeLocalAggregation() {
+    if (local_aggregation_size == 0) {
+      return;
+    }
+    parallel_for(0, local_aggregation_size, [&](long slot) {
+      uintV v = local_aggregation_vertices[slot];
+      for (int w = 0; w < local_aggregation_workers; w++) {
+        long i = w * local_aggregation_size + slot;
+        if (local_aggregation_touched[i]) {
+          addToAggregation(local_aggregation_values[i], delta[v], global_info);
+          local_aggregation_values[i] =
+              aggregationValueIdentity<AggregationValueType>();
+          local_aggregation_touched[i] = false;
+        }
+      }
+    });
+  }
+
+  // Whether iteration iter of the traditional computation should pull. The
+  // active edges are the out-degree sum of frontier_curr, which is counted
+  // for the adaptive executor before the edge computation. Pulling reads
+  // every in-edge once but each vertex only writes its own delta, so neither
+  // atomics nor locks are needed.
+  bool shouldPull(int iter) {
+    long active_edges = adaptive_executor.activeEdges(iter);
+    return pull_threshold > 0 &&
+           active_edges * pull_threshold > (long)my_graph.m;
   }
 
   // ======================================================================
   // DEPENDENCY DATA STORAGE
   // ======================================================================
   void createDependencyData() {
-    aggregation_values = newA(AggregationValueType *, history_iterations);
-    vertex_values = newA(VertexValueType *, history_iterations);
-    for (int i = 0; i < history_iterations; i++) {
-      aggregation_values[i] = newA(AggregationValueType, n);
-      vertex_values[i] = newA(VertexValueType, n);
+    if (sparse_history) {
+      cout << "Using sparse dependency history\n";
     }
+    aggregation_values.create(history_iterations, n, sparse_history);
+    vertex_values.create(history_iterations, n, sparse_history);
   }
   void resizeDependencyData() {
-    for (int i = 0; i < history_iterations; i++) {
-      aggregation_values[i] =
-          renewA(AggregationValueType, aggregation_values[i], n);
-      vertex_values[i] = renewA(VertexValueType, vertex_values[i], n);
-    }
+    aggregation_values.resize(n);
+    vertex_values.resize(n);
     initDependencyData(n_old, n);
   }
   void freeDependencyData() {
-    for (int i = 0; i < history_iterations; i++) {
-      deleteA(aggregation_values[i]);
-      deleteA(vertex_values[i]);
+    aggregation_values.del();
+    vertex_values.del();
+  }
+  void printDependencyDataSize() {
+    if (sparse_history) {
+      cout << "Dependency history entries : " << aggregation_values.size()
+           << " aggregation values, " << vertex_values.size()
+           << " vertex values (dense : " << (long)history_iterations * n
+           << " each)\n";
     }
-    deleteA(aggregation_values);
-    deleteA(vertex_values);
   }
   void initDependencyData() { initDependencyData(0, n); }
   void initDependencyData(long start_index, long end_index) {
-    for (int iter = 0; iter < history_iterations; iter++) {
-      parallel_for(long v = start_index; v < end_index; v++) {
-        initializeAggregationValue<AggregationValueType, GlobalInfoType>(
-            v, aggregation_values[iter][v], global_info);
-        initializeVertexValue<VertexValueType, GlobalInfoType>(
-            v, vertex_values[iter][v], global_info);
-      }
-    }
+    parallel_for(start_index, end_index, [&](long v) {
+      AggregationValueType aggregation_value;
+      VertexValueType vertex_value;
+      initializeAggregationValue<AggregationValueType, GlobalInfoType>(
+          v, aggregation_value, global_info);
+      initializeVertexValue<VertexValueType, GlobalInfoType>(v, vertex_value,
+                                                             global_info);
+      aggregation_values.init(v, aggregation_value);
+      vertex_values.init(v, vertex_value);
+    });
   }
 
   // ======================================================================
@@ -434,7 +597,7 @@ public:
   }
   virtual void initTemporaryStructures() { initTemporaryStructures(0, n); }
   virtual void initTemporaryStructures(long start_index, long end_index) {
-    parallel_for(long v = start_index; v < end_index; v++) {
+    parallel_for(start_index, end_index, [&](long v) {
       vertex_value_old_next[v] = vertexValueIdentity<VertexValueType>();
       vertex_value_old_curr[v] = vertexValueIdentity<VertexValueType>();
       vertex_value_old_prev[v] = vertexValueIdentity<VertexValueType>();
@@ -442,47 +605,58 @@ public:
       if (use_source_contribution)
         source_change_in_contribution[v] =
             aggregationValueIdentity<AggregationValueType>();
-    }
+    });
   }
 
   // ======================================================================
   // VERTEX SUBSETS USED BY THE BSP ENGINE
   // ======================================================================
   void createVertexSubsets() {
-    all = newA(bool, n);
-    frontier_curr = newA(bool, n);
-    frontier_next = newA(bool, n);
-    changed = newA(bool, n);
-    retract = newA(bool, n);
-    propagate = newA(bool, n);
+    all.create(n);
+    frontier_curr.create(n);
+    frontier_next.create(n);
+    changed.create(n);
+    retract.create(n);
+    propagate.create(n);
   }
   void resizeVertexSubsets() {
-    all = renewA(bool, all, n);
-    frontier_curr = renewA(bool, frontier_curr, n);
-    frontier_next = renewA(bool, frontier_next, n);
-    changed = renewA(bool, changed, n);
-    retract = renewA(bool, retract, n);
-    propagate = renewA(bool, propagate, n);
+    all.resize(n);
+    frontier_curr.resize(n);
+    frontier_next.resize(n);
+    changed.resize(n);
+    retract.resize(n);
+    propagate.resize(n);
     initVertexSubsets(n_old, n);
   }
   void freeVertexSubsets() {
-    deleteA(all);
-    deleteA(frontier_curr);
-    deleteA(frontier_next);
-    deleteA(changed);
-    deleteA(retract);
-    deleteA(propagate);
+    all.del();
+    frontier_curr.del();
+    frontier_next.del();
+    changed.del();
+    retract.del();
+    propagate.del();
   }
   void initVertexSubsets() { initVertexSubsets(0, n); }
   void initVertexSubsets(long start_index, long end_index) {
-    parallel_for(long j = start_index; j < end_index; j++) {
-      all[j] = 1;
-      frontier_curr[j] = 0;
-      frontier_next[j] = 0;
-      changed[j] = 0;
-      retract[j] = 0;
-      propagate[j] = 0;
-    }
+    all.fill(start_index, end_index, 1);
+    frontier_curr.fill(start_index, end_index, 0);
+    frontier_next.fill(start_index, end_index, 0);
+    changed.fill(start_index, end_index, 0);
+    retract.fill(start_index, end_index, 0);
+    propagate.fill(start_index, end_index, 0);
+  }
+
+  // Calls hasSourceChangedByUpdate() with the flags of v. The flags can only
+  // be set, so that the updates of other edges of v are not lost.
+  inline void sourceChangedByUpdate(uintV v, UpdateType update_type) {
+    bool activate = frontier_curr[v];
+    bool force_compute = changed[v];
+    hasSourceChangedByUpdate(v, update_type, activate, force_compute,
+                             global_info, global_info_old);
+    if (activate)
+      frontier_curr[v] = 1;
+    if (force_compute)
+      changed[v] = 1;
   }
 
   // ======================================================================
@@ -494,10 +668,7 @@ public:
     resizeDependencyData();
     resizeTemporaryStructures();
     resizeVertexSubsets();
-    if (use_lock) {
-      cout << "Resizing locks\n";
-      resizeLocks();
-    }
+    resizeLocalAggregation();
   }
 
   // ======================================================================
@@ -528,8 +699,10 @@ public:
       output_file.open(curr_output_file_path, ios::out);
       output_file << fixed;
       output_file << setprecision(VAL_PRECISION2);
-      for (uintV v = 0; v < n; v++) {
-        output_file << v << " " << my_graph.V[v].getInDegree() << " "
+      // in the input ids and order (-reorder)
+      for (uintV u = 0; u < n; u++) {
+        uintV v = my_graph.order.internalId(u);
+        output_file << u << " " << my_graph.V[v].getInDegree() << " "
                     << my_graph.V[v].getOutDegree() << " ";
         printAdditionalData(output_file, v, global_info);
         output_file << vertex_values[converged_iteration][v] << "\n";
@@ -541,12 +714,22 @@ public:
   // RUN AND INITIAL COMPUTE
   // ======================================================================
   void run() {
-    initialCompute();
+    string restore_path = config.getOptionValue("-restore", "");
+    CheckpointHeader checkpoint;
+    if (restore_path.empty()) {
+      initialCompute();
+    } else {
+      restoreCheckpoint(restore_path, checkpoint);
+    }
 
     // ======================================================================
     // Incremental Compute - Get the next update batch from ingestor
     // ======================================================================
     ingestor.validateAndOpenFifo();
+    if (!restore_path.empty()) {
+      ingestor.resumeStream(checkpoint.ingestor_batch,
+                            checkpoint.stream_position);
+    }
     while (ingestor.processNextBatch()) {
       current_batch++;
       edgeArray &edge_additions = ingestor.getEdgeAdditions();
@@ -554,6 +737,11 @@ public:
       // ingestor.edge_additions and ingestor.edge_deletions have been added
       // to the graph datastructure. Now, refine using it.
       deltaCompute(edge_additions, edge_deletions);
+      printDependencyDataSize();
+      if (!checkpoint_path.empty() &&
+          current_batch % checkpoint_interval == 0) {
+        saveCheckpoint();
+      }
     }
     freeTemporaryStructures();
   }
@@ -568,19 +756,102 @@ public:
     // Initilaize frontier
     // The other values are already initialized with the default values during
     // initialization of the GraphBoltEngine
-    parallel_for(uintV v = 0; v < n; v++) {
+    parallel_for(0, n, [&](uintV v) {
       frontier_next[v] = 0;
       frontier_curr[v] = 0;
       frontier_curr[v] = forceActivateVertexForIteration(v, 1, global_info);
-    }
+    });
     int iters = traditionalIncrementalComputation(1);
 
     cout << "Initial graph processing : " << full_timer.stop() << "\n";
     cout << "Number of iterations : " << iters << "\n";
+    printDependencyDataSize();
     printOutput();
     // testPrint();
   }
 
+  // ======================================================================
+  // CHECKPOINT / RESTORE
+  // ======================================================================
+  // Only the graph and the dependency data are saved. global_info is rebuilt
+  // from the restored graph by compute() and init(), like in initialCompute().
+  void saveCheckpoint() {
+    timer checkpoint_timer;
+    checkpoint_timer.start();
+    CheckpointHeader header(graphbolt_checkpoint);
+    header.n = n;
+    header.m = my_graph.m;
+    header.aggregation_value_size = sizeof(AggregationValueType);
+    header.vertex_value_size = sizeof(VertexValueType);
+    header.history_iterations = history_iterations;
+    header.converged_iteration = converged_iteration;
+    header.engine_batch = current_batch;
+    header.ingestor_batch = ingestor.current_batch;
+    header.stream_position = ingestor.stream_position;
+
+    bool success = writeCheckpointGraph(my_graph, checkpoint_path, header);
+    FILE *f = success ? beginCheckpointState(checkpoint_path, header) : NULL;
+    if (f != NULL) {
+      AggregationValueType *aggregation_iteration =
+          newA(AggregationValueType, n);
+      VertexValueType *vertex_iteration = newA(VertexValueType, n);
+      for (int iter = 0; iter < history_iterations; iter++) {
+        aggregation_values.getIteration(iter, aggregation_iteration);
+        vertex_values.getIteration(iter, vertex_iteration);
+        success = success &&
+                  writeCheckpointArray(f, aggregation_iteration, n) &&
+                  writeCheckpointArray(f, vertex_iteration, n);
+      }
+      deleteA(aggregation_iteration);
+      deleteA(vertex_iteration);
+      success = commitCheckpointState(f, checkpoint_path, success);
+    } else {
+      success = false;
+    }
+    if (!success) {
+      cout << "WARNING: Could not write checkpoint " << checkpoint_path
+           << "\n";
+      return;
+    }
+    cout << "Checkpoint after batch " << current_batch << " : "
+         << checkpoint_timer.stop() << "\n";
+  }
+
+  void restoreCheckpoint(const string &prefix, CheckpointHeader &header) {
+    timer restore_timer;
+    restore_timer.start();
+    FILE *f = openCheckpointState(prefix, header, graphbolt_checkpoint, n,
+                                  my_graph.m);
+    if (header.aggregation_value_size != sizeof(AggregationValueType) ||
+        header.vertex_value_size != sizeof(VertexValueType) ||
+        header.history_iterations != history_iterations) {
+      std::cerr << "Checkpoint was taken with a different application or "
+                   "-maxIters\n";
+      exit(1);
+    }
+    global_info.init();
+    AggregationValueType *aggregation_iteration =
+        newA(AggregationValueType, n);
+    VertexValueType *vertex_iteration = newA(VertexValueType, n);
+    for (int iter = 0; iter < history_iterations; iter++) {
+      if (!readCheckpointArray(f, aggregation_iteration, n) ||
+          !readCheckpointArray(f, vertex_iteration, n)) {
+        std::cerr << "Checkpoint " << checkpointStatePath(prefix)
+                  << " is truncated\n";
+        exit(1);
+      }
+      aggregation_values.setIteration(iter, aggregation_iteration);
+      vertex_values.setIteration(iter, vertex_iteration);
+    }
+    deleteA(aggregation_iteration);
+    deleteA(vertex_iteration);
+    fclose(f);
+    converged_iteration = header.converged_iteration;
+    current_batch = header.engine_batch;
+    cout << "Restored checkpoint after batch " << current_batch << " : "
+         << restore_timer.stop() << "\n";
+  }
+
   virtual int traditionalIncrementalComputation(int start_iteration) = 0;
   virtual void deltaCompute(edgeArray &edge_additions,
                             edgeArray &edge_deletions) = 0;
@@ -595,7 +866,7 @@ public:
       }
     }
     // Update approximate_time_for_prev_iteration for next iteration
-    parallel_for(uintV v = 0; v < n; v++) {
+    parallel_for(0, n, [&](uintV v) {
       if ((iter > 0 && notDelZero(vertex_values[iter][v],
                                  vertex_values[iter - 1][v], global_info)) ||
           forceActivateVertexForIteration(v, iter + 1, global_info)) {
@@ -605,9 +876,8 @@ public:
       } else {
         frontier_next[v] = 0;
       }
-    }
-    long active_edges =
-        sequence::plusReduceDegree(my_graph.V, frontier_next, (long)n);
+    });
+    long active_edges = frontier_next.outDegreeSum(my_graph.V);
     adaptive_executor.updateApproximateTimeForEdges(active_edges);
 
     return false;
@@ -616,7 +886,7 @@ public:
   int performSwitch(int iter) {
     // If called at beginning of iteration, use iter-1 and iter-2 to decide
     // whether a vertex is active
-    parallel_for(uintV v = 0; v < n; v++) {
+    parallel_for(0, n, [&](uintV v) {
       if (notDelZero(vertex_values[iter - 1][v], vertex_values[iter - 2][v],
                     global_info) ||
           forceActivateVertexForIteration(v, iter, global_info)) {
@@ -633,7 +903,7 @@ public:
         frontier_curr[v] = 0;
       }
       frontier_next[v] = 0;
-    }
+    });
     cout << "*\n";
 
     return traditionalIncrementalComputation(iter);
@@ -66,10 +66,10 @@ public:
   AggregationValueType *source_change_in_contribution_old;
   GraphBoltEngineComplex(graph<vertex> &_my_graph, int _max_iter,
                          GlobalInfoType &_static_data, bool _use_lock,
-                         commandLine _config)
+                         commandLine _config, bool local_aggregation = false)
       : GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
                         GlobalInfoType>(_my_graph, _max_iter, _static_data,
-                                        _use_lock, _config) {
+                                        _use_lock, _config, local_aggregation) {
     use_source_contribution = false;
   }
 
@@ -102,10 +102,10 @@ public:
   void initTemporaryStructures() { initTemporaryStructures(0, n); }
   void initTemporaryStructures(long start_index, long end_index) {
     if (use_source_contribution) {
-      parallel_for(long v = start_index; v < end_index; v++) {
+      parallel_for(start_index, end_index, [&](long v) {
         source_change_in_contribution_old[v] =
             aggregationValueIdentity<AggregationValueType>();
-      }
+      });
     }
     GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
                     GlobalInfoType>::initTemporaryStructures(start_index,
@@ -119,9 +119,8 @@ public:
     timer iteration_timer, phase_timer;
     double misc_time, copy_time, phase_time, iteration_time;
 
-    vertexSubset frontier_curr_vs(n, frontier_curr);
     bool use_delta = true;
-    if (frontier_curr_vs.numNonzeros() == 0) {
+    if (!frontier_curr.any()) {
       converged_iteration = start_iteration;
     } else {
       for (int iter = start_iteration; iter < max_iterations; iter++) {
@@ -133,21 +132,22 @@ public:
         }
 
         // ========== COPY - Prepare curr iteration ==========
+        aggregation_values.setLastIteration(iter);
+        vertex_values.setLastIteration(iter);
         if (iter > 0) {
           // Copy the aggregate and actual value from iter-1 to iter
-          parallel_for(uintV v = 0; v < n; v++) {
-            vertex_values[iter][v] = vertex_values[iter - 1][v];
-            aggregation_values[iter][v] = aggregation_values[iter - 1][v];
+          parallel_for(0, n, [&](uintV v) {
+            vertex_values.discardFrom(v, iter);
+            aggregation_values.discardFrom(v, iter);
             delta[v] = aggregationValueIdentity<AggregationValueType>();
-          }
+          });
         }
         use_delta = shouldUseDelta(iter);
         phase_time = phase_timer.next();
         adaptive_executor.updateCopyTime(iter, phase_time);
 
         // ========== MISC - count active edges for AE ==========
-        adaptive_executor.updateEdgesProcessed(iter, my_graph,
-                                               frontier_curr_vs);
+        adaptive_executor.updateEdgesProcessed(iter, my_graph, frontier_curr);
         phase_time = phase_timer.next();
         misc_time = phase_time;
 
@@ -156,19 +156,52 @@ public:
         // ========== EDGE COMPUTATION ==========
         if ((use_source_contribution) && (iter == 1)) {
           // Compute source contribution for first iteration
-          parallel_for(uintV u = 0; u < n; u++) {
-            if (frontier_curr[u]) {
-              sourceChangeInContribution<AggregationValueType, VertexValueType,
-                                         GlobalInfoType>(
-                  u, source_change_in_contribution[u],
-                  vertexValueIdentity<VertexValueType>(),
-                  vertex_values[iter - 1][u], global_info);
-            }
-          }
+          frontier_curr.forEach([&](uintV u) {
+            sourceChangeInContribution<AggregationValueType, VertexValueType,
+                                       GlobalInfoType>(
+                u, source_change_in_contribution[u],
+                vertexValueIdentity<VertexValueType>(),
+                vertex_values[iter - 1][u], global_info);
+          });
         }
 
-        parallel_for(uintV u = 0; u < n; u++) {
-          if (frontier_curr[u]) {
+        if (shouldPull(iter)) {
+          // Each vertex gathers from its active inNeighbors
+          parallel_for(0, n, [&](uintV v) {
+            intE inDegree = my_graph.V[v].getInDegree();
+            for (intE j = 0; j < inDegree; j++) {
+              uintV u = my_graph.V[v].getInNeighbor(j);
+              if (!frontier_curr[u])
+                continue;
+              AggregationValueType contrib_change =
+                  use_source_contribution
+                      ? source_change_in_contribution[u]
+                      : aggregationValueIdentity<AggregationValueType>();
+              bool ret = false;
+#ifdef EDGEDATA
+              EdgeData *edge_data = my_graph.V[v].getInEdgeData(j);
+#else
+              EdgeData *edge_data = &emptyEdgeData;
+#endif
+              if (use_delta) {
+                ret = edgeFunctionDelta(
+                    u, v, *edge_data, vertex_values[iter - 2][u],
+                    vertex_values[iter - 1][u], contrib_change, global_info);
+              } else {
+                ret =
+                    edgeFunction(u, v, *edge_data, vertex_values[iter - 1][u],
+                                 contrib_change, global_info);
+              }
+
+              if (ret) {
+                addToAggregation(contrib_change, delta[v], global_info);
+                if (!frontier_next[v])
+                  frontier_next[v] = 1;
+              }
+            }
+          });
+        } else {
+          frontier_curr.forEach([&](uintV u) {
             // check for propagate and retract for the vertices.
             intE outDegree = my_graph.V[u].getOutDegree();
             granular_for(j, 0, outDegree, (outDegree > 1024), {
@@ -189,31 +222,26 @@ public:
                     u, v, *edge_data, vertex_values[iter - 2][u],
                     vertex_values[iter - 1][u], contrib_change, global_info);
               } else {
-                ret = edgeFunction(u, v, *edge_data, vertex_values[iter - 1][u],
-                                   contrib_change, global_info);
+                ret =
+                    edgeFunction(u, v, *edge_data, vertex_values[iter - 1][u],
+                                 contrib_change, global_info);
               }
 
-              // lock if needed
               if (ret) {
-                if (use_lock) {
-                  vertex_locks[v].writeLock();
-                  addToAggregation(contrib_change, delta[v], global_info);
-                  vertex_locks[v].unlock();
-                } else {
-                  addToAggregationAtomic(contrib_change, delta[v], global_info);
-                }
+                addToDelta(v, contrib_change, global_info);
                 if (!frontier_next[v])
                   frontier_next[v] = 1;
               }
             });
-          }
+          });
+          mergeLocalAggregation();
         }
 
         phase_time = phase_timer.next();
         adaptive_executor.updateEdgeMapTime(iter, phase_time);
 
         // ========== VERTEX COMPUTATION ==========
-        parallel_for(uintV v = 0; v < n; v++) {
+        parallel_for(0, n, [&](uintV v) {
           // Reset frontier for next iteration
           frontier_curr[v] = 0;
           if (frontier_next[v] ||
@@ -222,24 +250,26 @@ public:
 
             // Update aggregation value and reset change received[v] (i.e.
             // delta[v])
-            addToAggregation(delta[v], aggregation_values[iter][v],
-                             global_info);
+            AggregationValueType aggregation_value =
+                aggregation_values[iter][v];
+            addToAggregation(delta[v], aggregation_value, global_info);
+            aggregation_values.set(v, iter, aggregation_value);
             delta[v] = aggregationValueIdentity<AggregationValueType>();
 
             // Calculate new_value based on the updated aggregation value
             VertexValueType new_value;
-            computeFunction(v, aggregation_values[iter][v],
-                            vertex_values[iter - 1][v], new_value, global_info);
+            computeFunction(v, aggregation_value, vertex_values[iter - 1][v],
+                            new_value, global_info);
 
             // Check if change is significant
             if (notDelZero(new_value, vertex_values[iter - 1][v], global_info)) {
               // change is significant. Update vertex_values
-              vertex_values[iter][v] = new_value;
+              vertex_values.set(v, iter, new_value);
               // Set active for next iteration.
               frontier_curr[v] = 1;
             } else {
               // change is not significant. Copy vertex_values[iter-1]
-              vertex_values[iter][v] = vertex_values[iter - 1][v];
+              vertex_values.copyPrevious(v, iter);
             }
           }
           frontier_curr[v] =
@@ -255,12 +285,10 @@ public:
                   global_info);
             }
           }
-        }
+        });
         phase_time = phase_timer.stop();
         adaptive_executor.updateVertexMapTime(iter, phase_time);
 
-        vertexSubset temp_vs(n, frontier_curr);
-        frontier_curr_vs = temp_vs;
         misc_time += phase_timer.next();
         iteration_time = iteration_timer.stop();
 
@@ -270,7 +298,7 @@ public:
 
         // Convergence check
         converged_iteration = iter;
-        if (frontier_curr_vs.isEmpty()) {
+        if (!frontier_curr.any()) {
           break;
         }
       }
@@ -294,7 +322,7 @@ public:
     }
 
     // Reset values before incremental computation
-    parallel_for(uintV v = 0; v < n; v++) {
+    parallel_for(0, n, [&](uintV v) {
       frontier_curr[v] = 0;
       frontier_next[v] = 0;
       changed[v] = 0;
@@ -313,7 +341,7 @@ public:
         source_change_in_contribution_old[v] =
             aggregationValueIdentity<AggregationValueType>();
       }
-    }
+    });
 
     // ==================== UPDATE GLOBALINFO ===============================
 
@@ -323,16 +351,12 @@ public:
 
     // ========== EDGE COMPUTATION - DIRECT CHANGES - for first iter ==========
     pre_compute_timer.start();
-    parallel_for(long i = 0; i < edge_additions.size; i++) {
+    parallel_for(0, edge_additions.size, [&](long i) {
       uintV source = edge_additions.E[i].source;
       uintV destination = edge_additions.E[i].destination;
 
-      hasSourceChangedByUpdate(source, edge_addition_enum,
-                               frontier_curr[source], changed[source],
-                               global_info, global_info_old);
-      hasSourceChangedByUpdate(destination, edge_addition_enum,
-                               frontier_curr[destination], changed[destination],
-                               global_info, global_info_old);
+      sourceChangedByUpdate(source, edge_addition_enum);
+      sourceChangedByUpdate(destination, edge_addition_enum);
       if (forceActivateVertexForIteration(source, 1, global_info_old)) {
         // Update frontier and changed values
 
@@ -367,10 +391,10 @@ public:
                          vertex_values[0][source], contrib_change, global_info);
         if (ret) {
           if (use_lock) {
-            vertex_locks[destination].writeLock();
+            vertex_locks.lock(destination);
             addToAggregation(contrib_change, delta[destination],
                              global_info_old);
-            vertex_locks[destination].unlock();
+            vertex_locks.unlock(destination);
           } else {
             addToAggregationAtomic(contrib_change, delta[destination],
                                    global_info_old);
@@ -379,18 +403,14 @@ public:
             changed[destination] = true;
         }
       }
-    }
+    });
 
-    parallel_for(long i = 0; i < edge_deletions.size; i++) {
+    parallel_for(0, edge_deletions.size, [&](long i) {
       uintV source = edge_deletions.E[i].source;
       uintV destination = edge_deletions.E[i].destination;
 
-      hasSourceChangedByUpdate(source, edge_deletion_enum,
-                               frontier_curr[source], changed[source],
-                               global_info, global_info_old);
-      hasSourceChangedByUpdate(destination, edge_deletion_enum,
-                               frontier_curr[destination], changed[destination],
-                               global_info, global_info_old);
+      sourceChangedByUpdate(source, edge_deletion_enum);
+      sourceChangedByUpdate(destination, edge_deletion_enum);
       if (forceActivateVertexForIteration(source, 1, global_info_old)) {
         // Update frontier and changed values
         if (frontier_curr[source]) {
@@ -424,10 +444,10 @@ public:
                          vertex_values[0][source], contrib_change, global_info);
         if (ret) {
           if (use_lock) {
-            vertex_locks[destination].writeLock();
+            vertex_locks.lock(destination);
             removeFromAggregation(contrib_change, delta[destination],
                                   global_info_old);
-            vertex_locks[destination].unlock();
+            vertex_locks.unlock(destination);
           } else {
             removeFromAggregationAtomic(contrib_change, delta[destination],
                                         global_info_old);
@@ -436,11 +456,14 @@ public:
             changed[destination] = true;
         }
       }
-    }
+    });
     pre_compute_time = pre_compute_timer.stop();
 
     // =============== INCREMENTAL COMPUTE - REFINEMENT START ================
-    vertexSubset frontier_curr_vs(n, frontier_curr);
+    // Refinement reads the old values of the iterations up to
+    // converged_iteration after the previous iteration has been updated
+    aggregation_values.setLastIteration(converged_iteration);
+    vertex_values.setLastIteration(converged_iteration);
     bool should_switch_now = false;
     bool use_delta = true;
 
@@ -474,9 +497,9 @@ public:
         vertex_value_old_next = temp1;
 
         if (iter <= converged_iteration) {
-          parallel_for(uintV v = 0; v < n; v++) {
+          parallel_for(0, n, [&](uintV v) {
             vertex_value_old_next[v] = vertex_values[iter][v];
-          }
+          });
         } else {
           converged_iteration = performSwitch(iter);
           break;
@@ -487,107 +510,94 @@ public:
       // ========== EDGEMAP - TRANSITIVE CHANGES ==========
       if ((use_source_contribution) && (iter == 1)) {
         // Compute source contribution for first iteration
-        parallel_for(uintV u = 0; u < n; u++) {
-          if (frontier_curr[u]) {
-            // compute source change in contribution
-            sourceChangeInContribution<AggregationValueType, VertexValueType,
-                                       GlobalInfoType>(
-                u, source_change_in_contribution[u],
-                vertexValueIdentity<VertexValueType>(),
-                vertex_values[iter - 1][u], global_info);
+        frontier_curr.forEach([&](uintV u) {
+          // compute source change in contribution
+          sourceChangeInContribution<AggregationValueType, VertexValueType,
+                                     GlobalInfoType>(
+              u, source_change_in_contribution[u],
+              vertexValueIdentity<VertexValueType>(),
+              vertex_values[iter - 1][u], global_info);
 
-            sourceChangeInContribution<AggregationValueType, VertexValueType,
-                                       GlobalInfoType>(
-                u, source_change_in_contribution_old[u],
-                vertexValueIdentity<VertexValueType>(),
-                vertex_value_old_curr[u], global_info_old);
-          }
-        }
+          sourceChangeInContribution<AggregationValueType, VertexValueType,
+                                     GlobalInfoType>(
+              u, source_change_in_contribution_old[u],
+              vertexValueIdentity<VertexValueType>(),
+              vertex_value_old_curr[u], global_info_old);
+        });
       }
 
-      parallel_for(uintV u = 0; u < n; u++) {
-        if (frontier_curr[u]) {
-          // check for propagate and retract for the vertices.
-          intE outDegree = my_graph.V[u].getOutDegree();
-          granular_for(i, 0, outDegree, (outDegree > 1024), {
-            uintV v = my_graph.V[u].getOutNeighbor(i);
-            bool ret_old = false;
-            bool ret = false;
-
-            AggregationValueType to_retract =
-                use_source_contribution
-                    ? source_change_in_contribution_old[u]
-                    : aggregationValueIdentity<AggregationValueType>();
-            AggregationValueType to_propagate =
-                use_source_contribution
-                    ? source_change_in_contribution[u]
-                    : aggregationValueIdentity<AggregationValueType>();
-
-            // retract
-            if (retract[u]) {
+      frontier_curr.forEach([&](uintV u) {
+        // check for propagate and retract for the vertices.
+        intE outDegree = my_graph.V[u].getOutDegree();
+        granular_for(i, 0, outDegree, (outDegree > 1024), {
+          uintV v = my_graph.V[u].getOutNeighbor(i);
+          bool ret_old = false;
+          bool ret = false;
+
+          AggregationValueType to_retract =
+              use_source_contribution
+                  ? source_change_in_contribution_old[u]
+                  : aggregationValueIdentity<AggregationValueType>();
+          AggregationValueType to_propagate =
+              use_source_contribution
+                  ? source_change_in_contribution[u]
+                  : aggregationValueIdentity<AggregationValueType>();
+
+          // retract
+          if (retract[u]) {
 #ifdef EDGEDATA
-              EdgeData *edge_data = my_graph.V[u].getOutEdgeData(i);
+            EdgeData *edge_data = my_graph.V[u].getOutEdgeData(i);
 #else
-              EdgeData *edge_data = &emptyEdgeData;
+            EdgeData *edge_data = &emptyEdgeData;
 #endif
-              if (use_delta) {
-                ret_old = edgeFunctionDelta(
-                    u, v, *edge_data, vertex_value_old_prev[u],
-                    vertex_value_old_curr[u], to_retract, global_info_old);
-              } else {
-                // For first iteration, noDelta
-                ret_old =
-                    edgeFunction(u, v, *edge_data, vertex_value_old_curr[u],
-                                 to_retract, global_info_old);
-              }
+            if (use_delta) {
+              ret_old = edgeFunctionDelta(
+                  u, v, *edge_data, vertex_value_old_prev[u],
+                  vertex_value_old_curr[u], to_retract, global_info_old);
+            } else {
+              // For first iteration, noDelta
+              ret_old =
+                  edgeFunction(u, v, *edge_data, vertex_value_old_curr[u],
+                               to_retract, global_info_old);
             }
+          }
 
-            // propagate
-            if (propagate[u]) {
+          // propagate
+          if (propagate[u]) {
 #ifdef EDGEDATA
-              EdgeData *edge_data = my_graph.V[u].getOutEdgeData(i);
+            EdgeData *edge_data = my_graph.V[u].getOutEdgeData(i);
 #else
-              EdgeData *edge_data = &emptyEdgeData;
+            EdgeData *edge_data = &emptyEdgeData;
 #endif
-              if (use_delta) {
-                ret = edgeFunctionDelta(
-                    u, v, *edge_data, vertex_values[iter - 2][u],
-                    vertex_values[iter - 1][u], to_propagate, global_info);
-              } else {
-                // For first iteration, noDelta
-                ret = edgeFunction(u, v, *edge_data, vertex_values[iter - 1][u],
-                                   to_propagate, global_info);
-              }
+            if (use_delta) {
+              ret = edgeFunctionDelta(
+                  u, v, *edge_data, vertex_values[iter - 2][u],
+                  vertex_values[iter - 1][u], to_propagate, global_info);
+            } else {
+              // For first iteration, noDelta
+              ret = edgeFunction(u, v, *edge_data, vertex_values[iter - 1][u],
+                                 to_propagate, global_info);
             }
+          }
 
-            if (ret || ret_old) {
-              if (use_lock) {
-                vertex_locks[v].writeLock();
-                if (ret_old) {
-                  removeFromAggregation(to_retract, delta[v], global_info_old);
-                }
-                if (ret) {
-                  addToAggregation(to_propagate, delta[v], global_info);
-                }
-                vertex_locks[v].unlock();
-
-              } else {
-                removeFromAggregationAtomic(to_retract, delta[v],
-                                            global_info_old);
-                addToAggregationAtomic(to_propagate, delta[v], global_info);
-              }
-
-              if (!changed[v])
-                changed[v] = 1;
-            }
-          });
-        }
-      }
+          if (ret_old) {
+            removeFromDelta(v, to_retract, global_info_old);
+          }
+          if (ret) {
+            addToDelta(v, to_propagate, global_info);
+          }
+          if (ret || ret_old) {
+            if (!changed[v])
+              changed[v] = 1;
+          }
+        });
+      });
+      mergeLocalAggregation();
       phase_time = phase_timer.next();
 
       // ========== VERTEX COMPUTATION  ==========
       bool use_delta_next_iteration = shouldUseDelta(iter + 1);
-      parallel_for(uintV v = 0; v < n; v++) {
+      parallel_for(0, n, [&](uintV v) {
         if ((v >= n_old) && (changed[v] == false)) {
           changed[v] = forceComputeVertexForIteration(v, iter, global_info);
         }
@@ -599,11 +609,13 @@ public:
 
           // delta has the current cumulative change for the vertex.
           // Update the aggregation value in history
-          addToAggregation(delta[v], aggregation_values[iter][v], global_info);
+          AggregationValueType aggregation_value = aggregation_values[iter][v];
+          addToAggregation(delta[v], aggregation_value, global_info);
+          aggregation_values.set(v, iter, aggregation_value);
 
           VertexValueType new_value;
-          computeFunction(v, aggregation_values[iter][v],
-                          vertex_values[iter - 1][v], new_value, global_info);
+          computeFunction(v, aggregation_value, vertex_values[iter - 1][v],
+                          new_value, global_info);
 
           if (forceActivateVertexForIteration(v, iter + 1, global_info)) {
             frontier_curr[v] = 1;
@@ -614,7 +626,7 @@ public:
           // Update v_change based on updated graph
           if (notDelZero(new_value, vertex_values[iter - 1][v], global_info)) {
             // change is significant. Update vertex_values
-            vertex_values[iter][v] = new_value;
+            vertex_values.set(v, iter, new_value);
             frontier_curr[v] = 1;
             propagate[v] = 1;
             if (use_source_contribution) {
@@ -634,7 +646,7 @@ public:
             }
           } else {
             // change is not significant. Copy vertex_values[iter-1]
-            vertex_values[iter][v] = vertex_values[iter - 1][v];
+            vertex_values.copyPrevious(v, iter);
           }
 
           // Update v_change based on initial graph
@@ -661,12 +673,12 @@ public:
             }
           }
         }
-      }
+      });
       phase_time = phase_timer.next();
 
       // ========== EDGE COMPUTATION - DIRECT CHANGES - for next iter ==========
       bool has_direct_changes = false;
-      parallel_for(long i = 0; i < edge_additions.size; i++) {
+      parallel_for(0, edge_additions.size, [&](long i) {
         uintV source = edge_additions.E[i].source;
         uintV destination = edge_additions.E[i].destination;
 
@@ -710,10 +722,10 @@ public:
           }
           if (ret) {
             if (use_lock) {
-              vertex_locks[destination].writeLock();
+              vertex_locks.lock(destination);
               addToAggregation(contrib_change_old, delta[destination],
                                global_info_old);
-              vertex_locks[destination].unlock();
+              vertex_locks.unlock(destination);
             } else {
               addToAggregationAtomic(contrib_change_old, delta[destination],
                                      global_info_old);
@@ -724,9 +736,9 @@ public:
               has_direct_changes = true;
           }
         }
-      }
+      });
 
-      parallel_for(long i = 0; i < edge_deletions.size; i++) {
+      parallel_for(0, edge_deletions.size, [&](long i) {
         uintV source = edge_deletions.E[i].source;
         uintV destination = edge_deletions.E[i].destination;
 
@@ -771,10 +783,10 @@ public:
           }
           if (ret) {
             if (use_lock) {
-              vertex_locks[destination].writeLock();
+              vertex_locks.lock(destination);
               removeFromAggregation(contrib_change_old, delta[destination],
                                     global_info_old);
-              vertex_locks[destination].unlock();
+              vertex_locks.unlock(destination);
 
             } else {
               removeFromAggregationAtomic(contrib_change_old,
@@ -786,18 +798,14 @@ public:
               has_direct_changes = true;
           }
         }
-      }
+      });
       phase_time = phase_timer.next();
 
-      // Create frontier for next iteration
-      vertexSubset temp_vs(n, frontier_curr);
-      frontier_curr_vs = temp_vs;
-
       misc_time += phase_timer.next();
       iteration_time = iteration_timer.next();
 
       // Convergence check
-      if (!has_direct_changes && frontier_curr_vs.isEmpty()) {
+      if (!has_direct_changes && !frontier_curr.any()) {
         if (iter == converged_iteration) {
           break;
         } else if (iter > converged_iteration) {
@@ -897,5 +905,15 @@ public:
                         GlobalInfoType>::performSwitch;
   using GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
                         GlobalInfoType>::processVertexAddition;
+  using GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
+                        GlobalInfoType>::sourceChangedByUpdate;
+  using GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
+                        GlobalInfoType>::addToDelta;
+  using GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
+                        GlobalInfoType>::removeFromDelta;
+  using GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
+                        GlobalInfoType>::mergeLocalAggregation;
+  using GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
+                        GlobalInfoType>::shouldPull;
 };
 #endif
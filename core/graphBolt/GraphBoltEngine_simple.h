@@ -24,6 +24,11 @@
 
 #include "GraphBoltEngine.h"
 
+// The refinement of a batch works on lists of vertices instead of scanning
+// all n vertices while at most n / SPARSE_FRONTIER_FACTOR vertices are
+// tracked (see deltaCompute()).
+#define SPARSE_FRONTIER_FACTOR 20
+
 // ======================================================================
 // GRAPHBOLTENGINESIMPLE
 // ======================================================================
@@ -35,11 +40,101 @@ class GraphBoltEngineSimple
 public:
   GraphBoltEngineSimple(graph<vertex> &_my_graph, int _max_iter,
                         GlobalInfoType &_static_data, bool _use_lock,
-                        commandLine _config)
+                        commandLine _config, bool local_aggregation = false)
       : GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
                         GlobalInfoType>(_my_graph, _max_iter, _static_data,
-                                        _use_lock, _config) {
+                                        _use_lock, _config, local_aggregation) {
     use_source_contribution = true;
+    sparse_state_clean = false;
+    changed_count = 0;
+    frontier_count = 0;
+    tracked_count = 0;
+  }
+
+  // ======================================================================
+  // SPARSE REFINEMENT
+  // ======================================================================
+  // Small batches only affect a few vertices. In sparse mode, the refinement
+  // keeps the changed vertices and the frontier as lists, and the copy and
+  // vertex phases only visit the tracked vertices: the changed vertices and
+  // the endpoints of the edge updates. An untracked vertex has not been
+  // recomputed in this batch, so its old values are still in the history and
+  // are loaded into vertex_value_old_* when it gets tracked.
+  // When the tracked vertices exceed n / SPARSE_FRONTIER_FACTOR, the
+  // refinement switches back to the dense loops for the rest of the batch.
+  uintV *changed_list;
+  uintV *frontier_list;
+  uintV *tracked_list;
+  VertexFlags tracked;
+  long changed_count;
+  long frontier_count;
+  long tracked_count;
+  // True if the previous batch stayed in sparse mode. Then only its tracked
+  // vertices have to be reset before the next batch.
+  bool sparse_state_clean;
+
+  template <class F>
+  inline void forEachVertex(bool sparse, uintV *list, long count, F f) {
+    if (sparse) {
+      parallel_for(0, count, [&](long i) { f(list[i]); });
+    } else {
+      parallel_for(0, n, [&](uintV v) { f(v); });
+    }
+  }
+
+  // Applies f to the vertices in frontier_curr
+  template <class F> inline void forEachActiveVertex(bool sparse, F f) {
+    if (sparse) {
+      parallel_for(0, frontier_count, [&](long i) { f(frontier_list[i]); });
+    } else {
+      frontier_curr.forEach(f);
+    }
+  }
+
+  inline void resetVertex(uintV v) {
+    frontier_curr[v] = 0;
+    frontier_next[v] = 0;
+    changed[v] = 0;
+
+    vertex_value_old_prev[v] = vertexValueIdentity<VertexValueType>();
+    vertex_value_old_curr[v] = vertexValueIdentity<VertexValueType>();
+    initializeVertexValue<VertexValueType>(v, vertex_value_old_next[v],
+                                           global_info);
+
+    delta[v] = aggregationValueIdentity<AggregationValueType>();
+    if (use_source_contribution) {
+      source_change_in_contribution[v] =
+          aggregationValueIdentity<AggregationValueType>();
+    }
+  }
+
+  // Endpoints of the batch are tracked from the start of the refinement
+  inline void trackEndpoint(uintV v) {
+    if (tracked.testAndSet(v)) {
+      resetVertex(v);
+      tracked_list[pbbs::fetch_and_add(&tracked_count, 1)] = v;
+    }
+  }
+
+  // Marks v as changed during iteration iter. In sparse mode, v is added to
+  // changed_list and, if it was not tracked yet, its old values for iter - 1
+  // and iter are loaded.
+  inline void markChanged(uintV v, int iter, bool sparse) {
+    if (!sparse) {
+      if (!changed[v])
+        changed[v] = 1;
+      return;
+    }
+    if (!changed.testAndSet(v)) {
+      return;
+    }
+    changed_list[pbbs::fetch_and_add(&changed_count, 1)] = v;
+    if (!tracked[v]) {
+      tracked[v] = 1;
+      vertex_value_old_curr[v] = vertex_values[iter - 1][v];
+      vertex_value_old_next[v] = vertex_values[iter][v];
+      tracked_list[pbbs::fetch_and_add(&tracked_count, 1)] = v;
+    }
   }
 
   // ======================================================================
@@ -48,21 +143,34 @@ public:
   void createTemporaryStructures() {
     GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
                     GlobalInfoType>::createTemporaryStructures();
+    changed_list = newA(uintV, n);
+    frontier_list = newA(uintV, n);
+    tracked_list = newA(uintV, n);
+    tracked.create(n);
   }
   void resizeTemporaryStructures() {
     GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
                     GlobalInfoType>::resizeTemporaryStructures();
+    changed_list = renewA(uintV, changed_list, n);
+    frontier_list = renewA(uintV, frontier_list, n);
+    tracked_list = renewA(uintV, tracked_list, n);
+    tracked.resize(n);
     initTemporaryStructures(n_old, n);
   }
   void freeTemporaryStructures() {
     GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
                     GlobalInfoType>::freeTemporaryStructures();
+    deleteA(changed_list);
+    deleteA(frontier_list);
+    deleteA(tracked_list);
+    tracked.del();
   }
   void initTemporaryStructures() { initTemporaryStructures(0, n); }
   void initTemporaryStructures(long start_index, long end_index) {
     GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
                     GlobalInfoType>::initTemporaryStructures(start_index,
                                                              end_index);
+    tracked.fill(start_index, end_index, 0);
   }
   // ======================================================================
   // TRADITIONAL INCREMENTAL COMPUTATION
@@ -73,11 +181,10 @@ public:
     timer iteration_timer, phase_timer;
     double misc_time, copy_time, phase_time, iteration_time;
 
-    vertexSubset frontier_curr_vs(n, frontier_curr);
     bool use_delta = true;
     int iter = start_iteration;
 
-    if (frontier_curr_vs.numNonzeros() == 0) {
+    if (!frontier_curr.any()) {
       converged_iteration = start_iteration;
 
     } else {
@@ -90,41 +197,67 @@ public:
         }
 
         // ========== COPY - Prepare curr iteration ==========
+        aggregation_values.setLastIteration(iter);
+        vertex_values.setLastIteration(iter);
         if (iter > 0) {
           // Copy the aggregate and actual value from iter-1 to iter
-          parallel_for(uintV v = 0; v < n; v++) {
-            vertex_values[iter][v] = vertex_values[iter - 1][v];
-            aggregation_values[iter][v] = aggregation_values[iter - 1][v];
+          parallel_for(0, n, [&](uintV v) {
+            vertex_values.discardFrom(v, iter);
+            aggregation_values.discardFrom(v, iter);
             delta[v] = aggregationValueIdentity<AggregationValueType>();
-          }
+          });
         }
         use_delta = shouldUseDelta(iter);
 
         // ========== MISC - count active edges for AE ==========
         phase_time = phase_timer.next();
         adaptive_executor.updateCopyTime(iter, phase_time);
-        adaptive_executor.updateEdgesProcessed(iter, my_graph,
-                                               frontier_curr_vs);
+        adaptive_executor.updateEdgesProcessed(iter, my_graph, frontier_curr);
         misc_time = phase_timer.next();
         adaptive_executor.updateMiscTime(iter, phase_timer.next());
 
         // ========== EDGE COMPUTATION ==========
         if ((use_source_contribution) && (iter == 1)) {
           // Compute source contribution for first iteration
-          parallel_for(uintV u = 0; u < n; u++) {
-            if (frontier_curr[u]) {
-              // compute source change in contribution
-              sourceChangeInContribution<AggregationValueType, VertexValueType,
-                                         GlobalInfoType>(
-                  u, source_change_in_contribution[u],
-                  vertexValueIdentity<VertexValueType>(),
-                  vertex_values[iter - 1][u], global_info);
-            }
-          }
+          frontier_curr.forEach([&](uintV u) {
+            // compute source change in contribution
+            sourceChangeInContribution<AggregationValueType, VertexValueType,
+                                       GlobalInfoType>(
+                u, source_change_in_contribution[u],
+                vertexValueIdentity<VertexValueType>(),
+                vertex_values[iter - 1][u], global_info);
+          });
         }
 
-        parallel_for(uintV u = 0; u < n; u++) {
-          if (frontier_curr[u]) {
+        if (shouldPull(iter)) {
+          // Each vertex gathers from its active inNeighbors
+          parallel_for(0, n, [&](uintV v) {
+            intE inDegree = my_graph.V[v].getInDegree();
+            for (intE j = 0; j < inDegree; j++) {
+              uintV u = my_graph.V[v].getInNeighbor(j);
+              if (!frontier_curr[u])
+                continue;
+              AggregationValueType contrib_change =
+                  use_source_contribution
+                      ? source_change_in_contribution[u]
+                      : aggregationValueIdentity<AggregationValueType>();
+#ifdef EDGEDATA
+              EdgeData *edge_data = my_graph.V[v].getInEdgeData(j);
+#else
+              EdgeData *edge_data = &emptyEdgeData;
+#endif
+              bool ret =
+                  edgeFunction(u, v, *edge_data, vertex_values[iter - 1][u],
+                               contrib_change, global_info);
+              if (ret) {
+                addToAggregation(contrib_change, delta[v], global_info);
+                if (!frontier_next[v])
+                  frontier_next[v] = 1;
+              }
+            }
+          });
+        } else {
+          frontier_curr.forEach([&](uintV u) {
             // check for propagate and retract for the vertices.
             intE outDegree = my_graph.V[u].getOutDegree();
             granular_for(j, 0, outDegree, (outDegree > 1024), {
@@ -142,25 +275,20 @@ public:
                   edgeFunction(u, v, *edge_data, vertex_values[iter - 1][u],
                                contrib_change, global_info);
               if (ret) {
-                if (use_lock) {
-                  vertex_locks[v].writeLock();
-                  addToAggregation(contrib_change, delta[v], global_info);
-                  vertex_locks[v].unlock();
-                } else {
-                  addToAggregationAtomic(contrib_change, delta[v], global_info);
-                }
+                addToDelta(v, contrib_change, global_info);
                 if (!frontier_next[v])
                   frontier_next[v] = 1;
               }
             });
-          }
+          });
+          mergeLocalAggregation();
         }
 
         phase_time = phase_timer.next();
         adaptive_executor.updateEdgeMapTime(iter, phase_time);
 
         // ========== VERTEX COMPUTATION ==========
-        parallel_for(uintV v = 0; v < n; v++) {
+        parallel_for(0, n, [&](uintV v) {
           // Reset frontier for next iteration
           frontier_curr[v] = 0;
           // Process all vertices affected by EdgeMap
@@ -170,24 +298,26 @@ public:
             frontier_next[v] = 0;
             // Update aggregation value and reset change received[v] (i.e.
             // delta[v])
-            addToAggregation(delta[v], aggregation_values[iter][v],
-                             global_info);
+            AggregationValueType aggregation_value =
+                aggregation_values[iter][v];
+            addToAggregation(delta[v], aggregation_value, global_info);
+            aggregation_values.set(v, iter, aggregation_value);
             delta[v] = aggregationValueIdentity<AggregationValueType>();
 
             // Calculate new_value based on the updated aggregation value
             VertexValueType new_value;
-            computeFunction(v, aggregation_values[iter][v],
-                            vertex_values[iter - 1][v], new_value, global_info);
+            computeFunction(v, aggregation_value, vertex_values[iter - 1][v],
+                            new_value, global_info);
 
             // Check if change is significant
             if (notDelZero(new_value, vertex_values[iter - 1][v], global_info)) {
               // change is significant. Update vertex_values
-              vertex_values[iter][v] = new_value;
+              vertex_values.set(v, iter, new_value);
               // Set active for next iteration.
               frontier_curr[v] = 1;
             } else {
               // change is not significant. Copy vertex_values[iter-1]
-              vertex_values[iter][v] = vertex_values[iter - 1][v];
+              vertex_values.copyPrevious(v, iter);
             }
           }
           frontier_curr[v] =
@@ -206,12 +336,10 @@ public:
                   aggregationValueIdentity<AggregationValueType>();
             }
           }
-        }
+        });
         phase_time = phase_timer.stop();
         adaptive_executor.updateVertexMapTime(iter, phase_time);
 
-        vertexSubset temp_vs(n, frontier_curr);
-        frontier_curr_vs = temp_vs;
         misc_time += phase_timer.next();
         iteration_time = iteration_timer.stop();
 
@@ -220,7 +348,7 @@ public:
         }
         // Convergence check
         converged_iteration = iter;
-        if (frontier_curr_vs.isEmpty()) {
+        if (!frontier_curr.any()) {
           break;
         }
       }
@@ -247,21 +375,32 @@ public:
     }
 
     // Reset values before incremental computation
-    parallel_for(uintV v = 0; v < n; v++) {
-      frontier_curr[v] = 0;
-      frontier_next[v] = 0;
-      changed[v] = 0;
-
-      vertex_value_old_prev[v] = vertexValueIdentity<VertexValueType>();
-      vertex_value_old_curr[v] = vertexValueIdentity<VertexValueType>();
-      initializeVertexValue<VertexValueType>(v, vertex_value_old_next[v],
-                                             global_info);
-
-      delta[v] = aggregationValueIdentity<AggregationValueType>();
-      if (use_source_contribution) {
-        source_change_in_contribution[v] =
-            aggregationValueIdentity<AggregationValueType>();
-      }
+    bool sparse = !ae_enabled &&
+                  2 * (edge_additions.size + edge_deletions.size) <=
+                      n / SPARSE_FRONTIER_FACTOR;
+    if (sparse && sparse_state_clean) {
+      parallel_for(0, tracked_count, [&](long i) {
+        resetVertex(tracked_list[i]);
+        tracked[tracked_list[i]] = 0;
+      });
+    } else {
+      parallel_for(0, n, [&](uintV v) {
+        resetVertex(v);
+        tracked[v] = 0;
+      });
+    }
+    changed_count = 0;
+    frontier_count = 0;
+    tracked_count = 0;
+    if (sparse) {
+      parallel_for(0, edge_additions.size, [&](long i) {
+        trackEndpoint(edge_additions.E[i].source);
+        trackEndpoint(edge_additions.E[i].destination);
+      });
+      parallel_for(0, edge_deletions.size, [&](long i) {
+        trackEndpoint(edge_deletions.E[i].source);
+        trackEndpoint(edge_deletions.E[i].destination);
+      });
     }
 
     // ==================== UPDATE GLOBALINFO ===============================
@@ -278,17 +417,13 @@ public:
 
     // ========== EDGE COMPUTATION - DIRECT CHANGES - for first iter ==========
     pre_compute_timer.start();
-    parallel_for(long i = 0; i < edge_additions.size; i++) {
+    parallel_for(0, edge_additions.size, [&](long i) {
       uintV source = edge_additions.E[i].source;
       uintV destination = edge_additions.E[i].destination;
 
       // Update frontier and changed values
-      hasSourceChangedByUpdate(source, edge_addition_enum,
-                               frontier_curr[source], changed[source],
-                               global_info, global_info_old);
-      hasSourceChangedByUpdate(destination, edge_addition_enum,
-                               frontier_curr[destination], changed[destination],
-                               global_info, global_info_old);
+      sourceChangedByUpdate(source, edge_addition_enum);
+      sourceChangedByUpdate(destination, edge_addition_enum);
       if (forceActivateVertexForIteration(source, 1, global_info_old)) {
 
         if (frontier_curr[source]) {
@@ -317,10 +452,10 @@ public:
                          vertex_values[0][source], contrib_change, global_info);
         if (ret) {
           if (use_lock) {
-            vertex_locks[destination].writeLock();
+            vertex_locks.lock(destination);
             addToAggregation(contrib_change, delta[destination],
                              global_info_old);
-            vertex_locks[destination].unlock();
+            vertex_locks.unlock(destination);
           } else {
             addToAggregationAtomic(contrib_change, delta[destination],
                                    global_info_old);
@@ -329,18 +464,14 @@ public:
             changed[destination] = true;
         }
       }
-    }
+    });
 
-    parallel_for(long i = 0; i < edge_deletions.size; i++) {
+    parallel_for(0, edge_deletions.size, [&](long i) {
       uintV source = edge_deletions.E[i].source;
       uintV destination = edge_deletions.E[i].destination;
 
-      hasSourceChangedByUpdate(source, edge_deletion_enum,
-                               frontier_curr[source], changed[source],
-                               global_info, global_info_old);
-      hasSourceChangedByUpdate(destination, edge_deletion_enum,
-                               frontier_curr[destination], changed[destination],
-                               global_info, global_info_old);
+      sourceChangedByUpdate(source, edge_deletion_enum);
+      sourceChangedByUpdate(destination, edge_deletion_enum);
       if (forceActivateVertexForIteration(source, 1, global_info_old)) {
         // Update frontier and changed values
         if (frontier_curr[source]) {
@@ -369,10 +500,10 @@ public:
                                 global_info_old);
         if (ret) {
           if (use_lock) {
-            vertex_locks[destination].writeLock();
+            vertex_locks.lock(destination);
             removeFromAggregation(contrib_change, delta[destination],
                                   global_info_old);
-            vertex_locks[destination].unlock();
+            vertex_locks.unlock(destination);
           } else {
             removeFromAggregationAtomic(contrib_change, delta[destination],
                                         global_info_old);
@@ -381,11 +512,23 @@ public:
             changed[destination] = true;
         }
       }
+    });
+    if (sparse) {
+      // Only the endpoints can be changed or active at this point
+      changed_count =
+          sequence::filter(tracked_list, changed_list, tracked_count,
+                           [&](uintV v) { return (bool)changed[v]; });
+      frontier_count =
+          sequence::filter(tracked_list, frontier_list, tracked_count,
+                           [&](uintV v) { return (bool)frontier_curr[v]; });
     }
     pre_compute_time = pre_compute_timer.stop();
 
     // =============== INCREMENTAL COMPUTE - REFINEMENT START ================
-    vertexSubset frontier_curr_vs(n, frontier_curr);
+    // Refinement reads the old values of the iterations up to
+    // converged_iteration after the previous iteration has been updated
+    aggregation_values.setLastIteration(converged_iteration);
+    vertex_values.setLastIteration(converged_iteration);
     bool should_switch_now = false;
     bool use_delta = true;
 
@@ -396,9 +539,19 @@ public:
     for (int iter = 1; iter < max_iterations; iter++) {
       // Perform switch if needed
       if (should_switch_now) {
+        sparse = false;
         converged_iteration = performSwitch(iter);
         break;
       }
+      if (sparse && tracked_count > n / SPARSE_FRONTIER_FACTOR) {
+        // Too many vertices for the lists. The dense loops need the old
+        // values of all vertices.
+        parallel_for(0, n, [&](uintV v) {
+          if (!tracked[v])
+            vertex_value_old_next[v] = vertex_values[iter - 1][v];
+        });
+        sparse = false;
+      }
 
       // initialize timers
       {
@@ -418,10 +571,11 @@ public:
         vertex_value_old_next = temp1;
 
         if (iter <= converged_iteration) {
-          parallel_for(uintV v = 0; v < n; v++) {
+          forEachVertex(sparse, tracked_list, tracked_count, [&](uintV v) {
             vertex_value_old_next[v] = vertex_values[iter][v];
-          }
+          });
         } else {
+          sparse = false;
           converged_iteration = performSwitch(iter);
           break;
         }
@@ -430,72 +584,67 @@ public:
       // ========== EDGE COMPUTATION - TRANSITIVE CHANGES ==========
       if ((use_source_contribution) && (iter == 1)) {
         // Compute source contribution for first iteration
-        parallel_for(uintV u = 0; u < n; u++) {
-          if (frontier_curr[u]) {
-            // compute source change in contribution
-            AggregationValueType contrib_change =
-                aggregationValueIdentity<AggregationValueType>();
-            sourceChangeInContribution<AggregationValueType, VertexValueType,
-                                       GlobalInfoType>(
-                u, contrib_change, vertexValueIdentity<VertexValueType>(),
-                vertex_values[iter - 1][u], global_info);
-            addToAggregation(contrib_change, source_change_in_contribution[u],
-                             global_info);
-            sourceChangeInContribution<AggregationValueType, VertexValueType,
-                                       GlobalInfoType>(
-                u, contrib_change, vertexValueIdentity<VertexValueType>(),
-                vertex_value_old_curr[u], global_info_old);
-            removeFromAggregation(
-                contrib_change, source_change_in_contribution[u], global_info);
-          }
-        }
+        forEachActiveVertex(sparse, [&](uintV u) {
+          // compute source change in contribution
+          AggregationValueType contrib_change =
+              aggregationValueIdentity<AggregationValueType>();
+          sourceChangeInContribution<AggregationValueType, VertexValueType,
+                                     GlobalInfoType>(
+              u, contrib_change, vertexValueIdentity<VertexValueType>(),
+              vertex_values[iter - 1][u], global_info);
+          addToAggregation(contrib_change, source_change_in_contribution[u],
+                           global_info);
+          sourceChangeInContribution<AggregationValueType, VertexValueType,
+                                     GlobalInfoType>(
+              u, contrib_change, vertexValueIdentity<VertexValueType>(),
+              vertex_value_old_curr[u], global_info_old);
+          removeFromAggregation(
+              contrib_change, source_change_in_contribution[u], global_info);
+        });
       }
 
-      parallel_for(uintV u = 0; u < n; u++) {
-        if (frontier_curr[u]) {
-          // check for propagate and retract for the vertices.
-          intE outDegree = my_graph.V[u].getOutDegree();
+      forEachActiveVertex(sparse, [&](uintV u) {
+        // check for propagate and retract for the vertices.
+        intE outDegree = my_graph.V[u].getOutDegree();
 
-          granular_for(i, 0, outDegree, (outDegree > 1024), {
-            uintV v = my_graph.V[u].getOutNeighbor(i);
-            bool ret = false;
-            AggregationValueType contrib_change =
-                use_source_contribution
-                    ? source_change_in_contribution[u]
-                    : aggregationValueIdentity<AggregationValueType>();
+        granular_for(i, 0, outDegree, (outDegree > 1024), {
+          uintV v = my_graph.V[u].getOutNeighbor(i);
+          bool ret = false;
+          AggregationValueType contrib_change =
+              use_source_contribution
+                  ? source_change_in_contribution[u]
+                  : aggregationValueIdentity<AggregationValueType>();
 
 #ifdef EDGEDATA
-            EdgeData *edge_data = my_graph.V[u].getOutEdgeData(i);
+          EdgeData *edge_data = my_graph.V[u].getOutEdgeData(i);
 #else
-            EdgeData *edge_data = &emptyEdgeData;
+          EdgeData *edge_data = &emptyEdgeData;
 #endif
-            ret = edgeFunction(u, v, *edge_data, vertex_values[iter - 1][u],
-                               contrib_change, global_info);
+          ret = edgeFunction(u, v, *edge_data, vertex_values[iter - 1][u],
+                             contrib_change, global_info);
 
-            if (ret) {
-              if (use_lock) {
-                vertex_locks[v].writeLock();
-                if (ret) {
-                  addToAggregation(contrib_change, delta[v], global_info);
-                }
-                vertex_locks[v].unlock();
-
-              } else {
-                if (ret) {
-                  addToAggregationAtomic(contrib_change, delta[v], global_info);
-                }
-              }
-              if (!changed[v])
-                changed[v] = 1;
-            }
-          });
-        }
-      }
+          if (ret) {
+            addToDelta(v, contrib_change, global_info);
+            markChanged(v, iter, sparse);
+          }
+        });
+      });
+      mergeLocalAggregation();
       phase_time = phase_timer.next();
 
       // ========== VERTEX COMPUTATION  ==========
       bool use_delta_next_iteration = shouldUseDelta(iter + 1);
-      parallel_for(uintV v = 0; v < n; v++) {
+      if (sparse) {
+        parallel_for(0, frontier_count,
+                     [&](long i) { frontier_curr[frontier_list[i]] = 0; });
+        parallel_for(n_old, n, [&](uintV v) {
+          if (!changed[v] &&
+              forceComputeVertexForIteration(v, iter, global_info)) {
+            markChanged(v, iter, sparse);
+          }
+        });
+      }
+      forEachVertex(sparse, changed_list, changed_count, [&](uintV v) {
         // changed vertices need to be processed
         frontier_curr[v] = 0;
         if ((v >= n_old) && (changed[v] == false)) {
@@ -507,11 +656,13 @@ public:
 
           // delta has the current cumulative change for the vertex.
           // Update the aggregation value in history
-          addToAggregation(delta[v], aggregation_values[iter][v], global_info);
+          AggregationValueType aggregation_value = aggregation_values[iter][v];
+          addToAggregation(delta[v], aggregation_value, global_info);
+          aggregation_values.set(v, iter, aggregation_value);
 
           VertexValueType new_value;
-          computeFunction(v, aggregation_values[iter][v],
-                          vertex_values[iter - 1][v], new_value, global_info);
+          computeFunction(v, aggregation_value, vertex_values[iter - 1][v],
+                          new_value, global_info);
 
           if (forceActivateVertexForIteration(v, iter + 1, global_info)) {
             frontier_curr[v] = 1;
@@ -523,7 +674,7 @@ public:
 
           if (notDelZero(new_value, vertex_values[iter - 1][v], global_info)) {
             // change is significant. Update vertex_values
-            vertex_values[iter][v] = new_value;
+            vertex_values.set(v, iter, new_value);
             frontier_curr[v] = 1;
             if (use_delta_next_iteration) {
               sourceChangeInContribution<AggregationValueType, VertexValueType,
@@ -542,7 +693,7 @@ public:
 
           } else {
             // change is not significant. Copy vertex_values[iter-1]
-            vertex_values[iter][v] = vertex_values[iter - 1][v];
+            vertex_values.copyPrevious(v, iter);
           }
 
           if (notDelZero(vertex_value_old_next[v], vertex_value_old_curr[v],
@@ -566,12 +717,12 @@ public:
                                   global_info_old);
           }
         }
-      }
+      });
       phase_time = phase_timer.next();
 
       // ========== EDGE COMPUTATION - DIRECT CHANGES - for next iter ==========
       bool has_direct_changes = false;
-      parallel_for(long i = 0; i < edge_additions.size; i++) {
+      parallel_for(0, edge_additions.size, [&](long i) {
         uintV source = edge_additions.E[i].source;
         uintV destination = edge_additions.E[i].destination;
         AggregationValueType contrib_change;
@@ -603,23 +754,22 @@ public:
 
           if (ret) {
             if (use_lock) {
-              vertex_locks[destination].writeLock();
+              vertex_locks.lock(destination);
               addToAggregation(contrib_change, delta[destination],
                                global_info_old);
-              vertex_locks[destination].unlock();
+              vertex_locks.unlock(destination);
             } else {
               addToAggregationAtomic(contrib_change, delta[destination],
                                      global_info_old);
             }
-            if (!changed[destination])
-              changed[destination] = 1;
+            markChanged(destination, iter, sparse);
             if (!has_direct_changes)
               has_direct_changes = true;
           }
         }
-      }
+      });
 
-      parallel_for(long i = 0; i < edge_deletions.size; i++) {
+      parallel_for(0, edge_deletions.size, [&](long i) {
         uintV source = edge_deletions.E[i].source;
         uintV destination = edge_deletions.E[i].destination;
         AggregationValueType contrib_change;
@@ -651,32 +801,39 @@ public:
 
           if (ret) {
             if (use_lock) {
-              vertex_locks[destination].writeLock();
+              vertex_locks.lock(destination);
               removeFromAggregation(contrib_change, delta[destination],
                                     global_info_old);
-              vertex_locks[destination].unlock();
+              vertex_locks.unlock(destination);
 
             } else {
               removeFromAggregationAtomic(contrib_change, delta[destination],
                                           global_info_old);
             }
-            if (!changed[destination])
-              changed[destination] = 1;
+            markChanged(destination, iter, sparse);
             if (!has_direct_changes)
               has_direct_changes = true;
           }
         }
-      }
+      });
       phase_time = phase_timer.next();
 
-      vertexSubset temp_vs(n, frontier_curr);
-      frontier_curr_vs = temp_vs;
+      bool frontier_empty;
+      if (sparse) {
+        // The frontier is a subset of the changed vertices
+        frontier_count = sequence::filter(
+            changed_list, frontier_list, changed_count,
+            [&](uintV v) { return (bool)frontier_curr[v]; });
+        frontier_empty = (frontier_count == 0);
+      } else {
+        frontier_empty = !frontier_curr.any();
+      }
 
       misc_time += phase_timer.next();
       iteration_time = iteration_timer.next();
 
       // Convergence check
-      if (!has_direct_changes && frontier_curr_vs.isEmpty()) {
+      if (!has_direct_changes && frontier_empty) {
         // There are no more active vertices
         if (iter == converged_iteration) {
           break;
@@ -703,6 +860,7 @@ public:
       iteration_time += iteration_timer.stop();
     }
 
+    sparse_state_clean = sparse;
     cout << "Finished batch : " << full_timer.stop() << "\n";
     cout << "Number of iterations : " << converged_iteration << "\n";
     // testPrint();
@@ -774,5 +932,15 @@ public:
                         GlobalInfoType>::performSwitch;
   using GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
                         GlobalInfoType>::processVertexAddition;
+  using GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
+                        GlobalInfoType>::sourceChangedByUpdate;
+  using GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
+                        GlobalInfoType>::addToDelta;
+  using GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
+                        GlobalInfoType>::removeFromDelta;
+  using GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
+                        GlobalInfoType>::mergeLocalAggregation;
+  using GraphBoltEngine<vertex, AggregationValueType, VertexValueType,
+                        GlobalInfoType>::shouldPull;
 };
 #endif
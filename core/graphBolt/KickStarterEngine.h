@@ -24,10 +24,19 @@
 
 #include "../common/bitsetscheduler.h"
 #include "../common/utils.h"
+#include "checkpoint.h"
 #include "ingestor.h"
+#include <limits>
 #include <vector>
 
-#define MAX_LEVEL 65535
+// Type of the levels in the dependency trees. With 16-bit levels, the trees
+// can be at most 65534 levels deep. Build with -DDEEP_DEPENDENCY_TREES
+// (make DEEPTREES=1) for deeper trees, e.g. SSSP on road networks.
+#ifdef DEEP_DEPENDENCY_TREES
+typedef uint32_t DependencyLevel;
+#else
+typedef uint16_t DependencyLevel;
+#endif
 #define MAX_PARENT 4294967295
 
 #ifdef EDGEDATA
@@ -77,6 +86,17 @@ inline bool shouldPropagate(const VertexValueType &old_value,
                             const VertexValueType &new_value,
                             GlobalInfoType &global_info);
 
+// ======================================================================
+// VERTEX PRIORITY
+// ======================================================================
+// Only used if the engine is created with a bucket width (delta-stepping).
+// Vertices are processed in increasing order of priority / delta, so the
+// priority should grow with the distance from the frontier vertices. For
+// SSSP, the distance itself. Priorities must be non-negative.
+template <class VertexValueType, class GlobalInfoType>
+inline long vertexPriority(const VertexValueType &value,
+                           const GlobalInfoType &global_info);
+
 // ======================================================================
 // HELPER FUNCTIONS
 // ======================================================================
@@ -87,7 +107,8 @@ void printAdditionalData(ofstream &output_file, const uintV &v,
 // ======================================================================
 // KICKSTARTER ENGINE
 // ======================================================================
-template <class vertex, class VertexValueType, class GlobalInfoType>
+template <class vertex, class VertexValueType, class GlobalInfoType,
+          class LevelType = DependencyLevel>
 class KickStarterEngine {
 
 public:
@@ -104,21 +125,40 @@ public:
   long n_old;
   GlobalInfoType global_info_old;
 
-  template <class T> struct DependencyData {
+  // Level of the vertices that are not in a dependency tree
+  static const LevelType max_level = numeric_limits<LevelType>::max();
+
+  // Same fields as DependencyData. With cmpxchg16b, a DependencyData of 9 to
+  // 16 bytes (e.g. 32-bit levels) is padded and aligned to 16 bytes so that
+  // it can still be updated with a CAS.
+  template <class T> struct DependencyLayout {
     uintV parent;
     T value;
-    uint16_t level;
-    DependencyData() : level(MAX_LEVEL), value(), parent(MAX_PARENT) {}
+    LevelType level;
+  };
+  template <class T> static constexpr size_t dependencyAlignment() {
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_16
+    return (sizeof(DependencyLayout<T>) > 8 &&
+            sizeof(DependencyLayout<T>) <= 16)
+               ? 16
+               : alignof(DependencyLayout<T>);
+#else
+    return alignof(DependencyLayout<T>);
+#endif
+  }
 
-    DependencyData(uint16_t _level, T _value, uint32_t _parent)
-        : level(_level), value(_value), parent(_parent) {}
+  template <class T> struct alignas(dependencyAlignment<T>()) DependencyData {
+    uintV parent;
+    T value;
+    LevelType level;
+    DependencyData() : level(max_level), value(), parent(MAX_PARENT) {}
 
-    DependencyData(const DependencyData &object)
-        : level(object.level), value(object.value), parent(object.parent) {}
+    DependencyData(LevelType _level, T _value, uint32_t _parent)
+        : level(_level), value(_value), parent(_parent) {}
 
     void reset() {
       parent = MAX_PARENT;
-      level = MAX_LEVEL;
+      level = max_level;
     }
 
     inline bool operator==(const DependencyData &rhs) {
@@ -149,12 +189,58 @@ public:
   }
 
   DependencyData<VertexValueType> *dependency_data;
+  // reduce() updates the dependency data of a vertex with a single CAS if
+  // it fits in 8 bytes (16 bytes with cmpxchg16b). Wider dependency data is
+  // updated under a striped lock, for example with 64-bit values or vertex
+  // ids (-DLONG).
+  static const bool cas_dependency_data =
+      hasCAS<DependencyData<VertexValueType>>::value;
+  StripedLock dependency_locks;
+  // Set when a dependency tree gets deeper than LevelType allows
+  bool level_overflow;
+
+  // Width of the buckets of the delta-stepping scheduler (-delta), or 0 to
+  // process all the scheduled vertices in every iteration.
+  // buckets[b] holds the vertices added to bucket b. queued_bucket[v] is the
+  // bucket in which v waits to be processed, or NO_BUCKET, so that v is not
+  // added twice to the same bucket. The vertices improved while a bucket is
+  // processed are collected in improved_vertices[0, improved_count) and
+  // added to their buckets by queueImproved() after the round.
+  long bucket_delta;
+  vector<vector<uintV>> buckets;
+  size_t *queued_bucket;
+  uintV *improved_vertices;
+  bool *improved_queued;
+  long improved_count;
+  static const size_t NO_BUCKET = SIZE_MAX;
+  // Rounds with fewer improved vertices are queued serially
+  static const long QUEUE_IMPROVED_GRANULARITY = 2048;
+
+  // The dependency data at the start of the batch is only copied for the
+  // vertices written by the batch: dependency_data_old[v] is valid if
+  // dependency_epoch[v] == current_epoch, otherwise dependency_data[v] has
+  // not changed yet. See oldDependencyData().
   DependencyData<VertexValueType> *dependency_data_old;
+  uint32_t *dependency_epoch;
+  uint32_t current_epoch;
 
   // TODO : Replace with more efficient vertexSubset using bitmaps
+  // frontier and changed are all 0 between batches, all_affected_vertices is
+  // cleared through affected_vertices, so a batch never scans all vertices
+  // to reset them.
   bool *frontier;
   bool *all_affected_vertices;
   bool *changed;
+  uintV *affected_vertices;
+  long affected_count;
+
+  // Vertices to trim in the current and the next round of the trimming
+  // phase. trim_queued[v] is set while v is in trim_next.
+  uintV *trim_curr;
+  uintV *trim_next;
+  bool *trim_queued;
+  long trim_curr_count;
+  long trim_next_count;
 
   BitsetScheduler active_vertices_bitset;
 
@@ -162,13 +248,43 @@ public:
   Ingestor<vertex> ingestor;
   int current_batch;
 
+  // Checkpoints of the dependency data
+  string checkpoint_path;
+  long checkpoint_interval;
+
+  // default_delta > 0 enables the delta-stepping scheduler, with buckets of
+  // width default_delta unless -delta is given. Applications with uniform
+  // edge weights (BFS) gain nothing from it.
   KickStarterEngine(graph<vertex> &_my_graph, GlobalInfoType &_global_info,
-                    commandLine _config)
+                    commandLine _config, long default_delta = 0)
       : my_graph(_my_graph), global_info(_global_info), global_info_old(),
         config(_config), ingestor(_my_graph, _config), current_batch(0),
         active_vertices_bitset(my_graph.n) {
     n = my_graph.n;
     n_old = 0;
+    current_epoch = 0;
+    affected_count = 0;
+    trim_curr_count = 0;
+    trim_next_count = 0;
+    level_overflow = false;
+    checkpoint_path = config.getOptionValue("-checkpointPath", "");
+    checkpoint_interval =
+        max(1L, config.getOptionLongValue("-checkpointInterval", 1));
+    bucket_delta = 0;
+    improved_count = 0;
+    if (default_delta > 0) {
+      bucket_delta = max(0L, config.getOptionLongValue("-delta", default_delta));
+    }
+    if (bucket_delta > 0) {
+      cout << "Using buckets of width " << bucket_delta << "\n";
+    }
+    if (!cas_dependency_data) {
+      dependency_locks.create(
+          max(1L, config.getOptionLongValue("-lockStripes", 4096)));
+      cout << "Using locks for the dependency data of "
+           << sizeof(DependencyData<VertexValueType>) << " bytes ("
+           << dependency_locks.size() << " stripes)\n";
+    }
   }
 
   void init() {
@@ -184,6 +300,9 @@ public:
     freeDependencyData();
     freeTemporaryStructures();
     freeVertexSubsets();
+    if (!cas_dependency_data) {
+      dependency_locks.del();
+    }
     global_info.cleanup();
   }
 
@@ -201,11 +320,11 @@ public:
   void freeDependencyData() { deleteA(dependency_data); }
   void initDependencyData() { initDependencyData(0, n); }
   void initDependencyData(long start_index, long end_index) {
-    parallel_for(long v = start_index; v < end_index; v++) {
+    parallel_for(start_index, end_index, [&](long v) {
       dependency_data[v].reset();
       initializeVertexValue<VertexValueType, GlobalInfoType>(
           v, dependency_data[v].value, global_info);
-    }
+    });
   }
 
   // ======================================================================
@@ -213,15 +332,48 @@ public:
   // ======================================================================
   virtual void createTemporaryStructures() {
     dependency_data_old = newA(DependencyData<VertexValueType>, n);
+    dependency_epoch = newA(uint32_t, n);
   }
   virtual void resizeTemporaryStructures() {
     dependency_data_old =
         renewA(DependencyData<VertexValueType>, dependency_data_old, n);
+    dependency_epoch = renewA(uint32_t, dependency_epoch, n);
     initDependencyData(n_old, n);
+    initTemporaryStructures(n_old, n);
+  }
+  virtual void freeTemporaryStructures() {
+    deleteA(dependency_data_old);
+    deleteA(dependency_epoch);
   }
-  virtual void freeTemporaryStructures() { deleteA(dependency_data_old); }
   virtual void initTemporaryStructures() { initTemporaryStructures(0, n); }
-  virtual void initTemporaryStructures(long start_index, long end_index) {}
+  virtual void initTemporaryStructures(long start_index, long end_index) {
+    parallel_for(start_index, end_index,
+                 [&](long v) { dependency_epoch[v] = 0; });
+  }
+
+  // Starts a new version of the dependency data for the batch
+  void newEpoch() {
+    current_epoch++;
+    if (current_epoch == 0) {
+      initTemporaryStructures();
+      current_epoch = 1;
+    }
+  }
+
+  // Copies the dependency data of v before it is first written in the batch
+  inline void saveOldDependencyData(const uintV &v) {
+    if (dependency_epoch[v] != current_epoch) {
+      dependency_data_old[v] = dependency_data[v];
+      dependency_epoch[v] = current_epoch;
+    }
+  }
+
+  // Dependency data of v at the start of the batch
+  inline const DependencyData<VertexValueType> &
+  oldDependencyData(const uintV &v) const {
+    return (dependency_epoch[v] == current_epoch) ? dependency_data_old[v]
+                                                  : dependency_data[v];
+  }
 
   // ======================================================================
   // VERTEX SUBSETS USED BY THE ENGINE
@@ -230,33 +382,105 @@ public:
     frontier = newA(bool, n);
     all_affected_vertices = newA(bool, n);
     changed = newA(bool, n);
+    affected_vertices = newA(uintV, n);
+    trim_curr = newA(uintV, n);
+    trim_next = newA(uintV, n);
+    trim_queued = newA(bool, n);
+    if (bucket_delta > 0) {
+      queued_bucket = newA(size_t, n);
+      improved_vertices = newA(uintV, n);
+      improved_queued = newA(bool, n);
+    }
   }
   void resizeVertexSubsets() {
     frontier = renewA(bool, frontier, n);
     all_affected_vertices = renewA(bool, all_affected_vertices, n);
     changed = renewA(bool, changed, n);
+    affected_vertices = renewA(uintV, affected_vertices, n);
+    trim_curr = renewA(uintV, trim_curr, n);
+    trim_next = renewA(uintV, trim_next, n);
+    trim_queued = renewA(bool, trim_queued, n);
+    if (bucket_delta > 0) {
+      queued_bucket = renewA(size_t, queued_bucket, n);
+      improved_vertices = renewA(uintV, improved_vertices, n);
+      improved_queued = renewA(bool, improved_queued, n);
+    }
     initVertexSubsets(n_old, n);
   }
   void freeVertexSubsets() {
     deleteA(frontier);
     deleteA(all_affected_vertices);
     deleteA(changed);
+    deleteA(affected_vertices);
+    deleteA(trim_curr);
+    deleteA(trim_next);
+    deleteA(trim_queued);
+    if (bucket_delta > 0) {
+      deleteA(queued_bucket);
+      deleteA(improved_vertices);
+      deleteA(improved_queued);
+    }
   }
   void initVertexSubsets() { initVertexSubsets(0, n); }
   void initVertexSubsets(long start_index, long end_index) {
-    parallel_for(long j = start_index; j < end_index; j++) {
+    parallel_for(start_index, end_index, [&](long j) {
       frontier[j] = 0;
       all_affected_vertices[j] = 0;
       changed[j] = 0;
+      trim_queued[j] = 0;
+      if (bucket_delta > 0) {
+        queued_bucket[j] = NO_BUCKET;
+        improved_queued[j] = 0;
+      }
+    });
+  }
+
+  inline void markAffected(const uintV &v) {
+    if (!all_affected_vertices[v] &&
+        CAS(&all_affected_vertices[v], false, true)) {
+      affected_vertices[pbbs::fetch_and_add(&affected_count, 1)] = v;
     }
   }
 
+  // Adds v to the next round of the trimming phase
+  inline void scheduleTrim(const uintV &v) {
+    if (!trim_queued[v] && CAS(&trim_queued[v], false, true)) {
+      trim_next[pbbs::fetch_and_add(&trim_next_count, 1)] = v;
+    }
+  }
+
+  void clearAffected() {
+    parallel_for(0, affected_count, [&](long i) {
+      all_affected_vertices[affected_vertices[i]] = 0;
+    });
+    affected_count = 0;
+  }
+
+  // Calls f(v) for the vertices scheduled in the current iteration, skipping
+  // 64 vertices at a time. Vertices scheduled during the scan are seen if
+  // they come after the current one in its word, as with isScheduled().
+  template <class F> void forEachScheduled(F f) {
+    const IdType *words =
+        active_vertices_bitset.getCurrentBitset()->getArray();
+    const long bits_per_word = 8 * sizeof(IdType);
+    long num_words = (n + bits_per_word - 1) / bits_per_word;
+    parallel_for(0, num_words, [&](long i) {
+      IdType word = words[i];
+      while (word != 0) {
+        int bit = __builtin_ctzll(word);
+        f((uintV)(i * bits_per_word + bit));
+        word = words[i] & ((~IdType(0) << bit) << 1);
+      }
+    });
+  }
+
   void processVertexAddition(long maxVertex) {
     n_old = n;
     n = maxVertex + 1;
     resizeDependencyData();
     resizeTemporaryStructures();
     resizeVertexSubsets();
+    active_vertices_bitset.resize(n);
   }
 
   void testPrint() {
@@ -267,7 +491,7 @@ public:
       cout << "Outdegree " << my_graph.V[curr].getOutDegree() << "\n";
       cout << "DependencyData<VertexValueType> " << dependency_data[curr]
            << "\n";
-      cout << "DependencyDataOld " << dependency_data_old[curr] << "\n";
+      cout << "DependencyDataOld " << oldDependencyData(curr) << "\n";
     }
   }
 
@@ -285,8 +509,10 @@ public:
       output_file.open(curr_output_file_path, ios::out);
       output_file << fixed;
       output_file << setprecision(VAL_PRECISION2);
-      for (uintV v = 0; v < n; v++) {
-        output_file << v << " " << my_graph.V[v].getInDegree() << " "
+      // in the input ids and order (-reorder)
+      for (uintV u = 0; u < n; u++) {
+        uintV v = my_graph.order.internalId(u);
+        output_file << u << " " << my_graph.V[v].getInDegree() << " "
                     << my_graph.V[v].getOutDegree() << " ";
         printAdditionalData(output_file, v, global_info);
         output_file << dependency_data[v] << "\n";
@@ -297,13 +523,78 @@ public:
   }
 
   void run() {
-    initialCompute();
+    string restore_path = config.getOptionValue("-restore", "");
+    CheckpointHeader checkpoint;
+    if (restore_path.empty()) {
+      initialCompute();
+    } else {
+      restoreCheckpoint(restore_path, checkpoint);
+    }
     ingestor.validateAndOpenFifo();
+    if (!restore_path.empty()) {
+      ingestor.resumeStream(checkpoint.ingestor_batch,
+                            checkpoint.stream_position);
+    }
     while (ingestor.processNextBatch()) {
       edgeArray &edge_additions = ingestor.getEdgeAdditions();
       edgeArray &edge_deletions = ingestor.getEdgeDeletions();
       deltaCompute(edge_additions, edge_deletions);
+      if (!checkpoint_path.empty() &&
+          ingestor.current_batch % checkpoint_interval == 0) {
+        saveCheckpoint();
+      }
+    }
+  }
+
+  // ======================================================================
+  // CHECKPOINT / RESTORE
+  // ======================================================================
+  void saveCheckpoint() {
+    timer checkpoint_timer;
+    checkpoint_timer.start();
+    CheckpointHeader header(kickstarter_checkpoint);
+    header.n = n;
+    header.m = my_graph.m;
+    header.vertex_value_size = sizeof(DependencyData<VertexValueType>);
+    header.engine_batch = current_batch;
+    header.ingestor_batch = ingestor.current_batch;
+    header.stream_position = ingestor.stream_position;
+
+    bool success = writeCheckpointGraph(my_graph, checkpoint_path, header);
+    FILE *f = success ? beginCheckpointState(checkpoint_path, header) : NULL;
+    if (f != NULL) {
+      success = commitCheckpointState(
+          f, checkpoint_path, writeCheckpointArray(f, dependency_data, n));
+    } else {
+      success = false;
+    }
+    if (!success) {
+      cout << "WARNING: Could not write checkpoint " << checkpoint_path
+           << "\n";
+      return;
     }
+    cout << "Checkpoint after batch " << ingestor.current_batch << " : "
+         << checkpoint_timer.stop() << "\n";
+  }
+
+  void restoreCheckpoint(const string &prefix, CheckpointHeader &header) {
+    timer restore_timer;
+    restore_timer.start();
+    FILE *f = openCheckpointState(prefix, header, kickstarter_checkpoint, n,
+                                  my_graph.m);
+    if (header.vertex_value_size != sizeof(DependencyData<VertexValueType>)) {
+      std::cerr << "Checkpoint was taken with a different application\n";
+      exit(1);
+    }
+    if (!readCheckpointArray(f, dependency_data, n)) {
+      std::cerr << "Checkpoint " << checkpointStatePath(prefix)
+                << " is truncated\n";
+      exit(1);
+    }
+    fclose(f);
+    current_batch = header.engine_batch;
+    cout << "Restored checkpoint after batch " << header.ingestor_batch
+         << " : " << restore_timer.stop() << "\n";
   }
 
   void initialCompute() {
@@ -311,37 +602,74 @@ public:
     full_timer.start();
     active_vertices_bitset.reset();
 
-    parallel_for(uintV v = 0; v < n; v++) {
+    parallel_for(0, n, [&](uintV v) {
       if (frontierVertex(v, global_info)) {
         active_vertices_bitset.schedule(v);
         dependency_data[v].level = 0;
         dependency_data[v].parent = v;
       }
-    }
+    });
 
     traditionalIncrementalComputation();
     cout << "Initial graph processing : " << full_timer.stop() << "\n";
     printOutput();
   }
 
-  // TODO : Write a lock based reduce function. Add functionality to use the
-  // lock based reduce function depending on the size of DependendencyData              
+  // Copy of data (the dependency data of u) that is not torn by a concurrent
+  // reduce(). Dependency data of up to 8 bytes is read with a single load.
+  inline DependencyData<VertexValueType>
+  loadDependencyData(const uintV &u,
+                     const DependencyData<VertexValueType> &data) {
+    DependencyData<VertexValueType> ret;
+    if (!cas_dependency_data) {
+      dependency_locks.lock(u);
+      ret = data;
+      dependency_locks.unlock(u);
+    } else if (sizeof(DependencyData<VertexValueType>) == 16) {
+      auto ptr = const_cast<DependencyData<VertexValueType> *>(&data);
+      do {
+        memcpy((void *)&ret, (const void *)&data, sizeof(ret));
+      } while (!CAS(ptr, ret, ret));
+    } else {
+      ret = data;
+    }
+    return ret;
+  }
+
   bool reduce(const uintV &u, const uintV &v, const EdgeData &edge_data,
               const DependencyData<VertexValueType> &u_data,
               DependencyData<VertexValueType> &v_data, GlobalInfoType &info) {
     DependencyData<VertexValueType> newV, oldV;
-    DependencyData<VertexValueType> incoming_value_curr = u_data;
+    DependencyData<VertexValueType> incoming_value_curr =
+        loadDependencyData(u, u_data);
 
     bool ret = edgeFunction(u, v, edge_data, incoming_value_curr.value, newV.value, info);
     if (!ret) {
       return false;
     }
+    if (incoming_value_curr.level >= max_level - 1) {
+      level_overflow = true;
+      return false;
+    }
     newV.level = incoming_value_curr.level + 1;
     newV.parent = u;
 
     bool update_successful = true;
-    do {
+    if (!cas_dependency_data) {
+      dependency_locks.lock(v);
       oldV = v_data;
+      if ((shouldPropagate(oldV.value, newV.value, global_info)) ||
+          ((oldV.value == newV.value) && (oldV.level <= newV.level))) {
+        update_successful = false;
+      } else {
+        v_data = newV;
+      }
+      dependency_locks.unlock(v);
+      return update_successful;
+    }
+    do {
+      // Copies the padding bytes as well, since CAS compares them
+      memcpy((void *)&oldV, (void *)&v_data, sizeof(oldV));
       // If oldV is lesser than the newV computed frm u, we should update.
       // Otherwise, break
       if ((shouldPropagate(oldV.value, newV.value, global_info)) ||
@@ -353,11 +681,157 @@ public:
     return update_successful;
   }
 
+  // Bucket of v for the delta-stepping scheduler
+  inline size_t bucketOf(const uintV &v) {
+    long priority = vertexPriority<VertexValueType, GlobalInfoType>(
+        dependency_data[v].value, global_info);
+    return max(0L, priority) / bucket_delta;
+  }
+
+  // Adds v to the vertices to queue after the current bucket
+  inline void markImproved(const uintV &v) {
+    if (!improved_queued[v] && CAS(&improved_queued[v], false, true)) {
+      improved_vertices[pbbs::fetch_and_add(&improved_count, 1)] = v;
+    }
+  }
+
+  // Moves v to its bucket, or to curr_bucket if its bucket was already
+  // processed. Returns that bucket, or NO_BUCKET if v is already queued there.
+  inline size_t requeueImproved(const uintV &v, size_t curr_bucket) {
+    improved_queued[v] = false;
+    size_t bucket = max(curr_bucket, bucketOf(v));
+    if (queued_bucket[v] == bucket) {
+      return NO_BUCKET;
+    }
+    queued_bucket[v] = bucket;
+    return bucket;
+  }
+
+  // Adds the improved vertices to their buckets. Small rounds are queued
+  // serially. Otherwise, the buckets are computed in parallel, the vertices
+  // are grouped by bucket with a radix sort on the offset from curr_bucket,
+  // and each group is appended to its bucket in parallel.
+  void queueImproved(size_t curr_bucket) {
+    long k = improved_count;
+    improved_count = 0;
+    if (k < QUEUE_IMPROVED_GRANULARITY) {
+      for (long i = 0; i < k; i++) {
+        uintV v = improved_vertices[i];
+        size_t bucket = requeueImproved(v, curr_bucket);
+        if (bucket != NO_BUCKET) {
+          if (buckets.size() <= bucket) {
+            buckets.resize(bucket + 1);
+          }
+          buckets[bucket].push_back(v);
+        }
+      }
+      return;
+    }
+
+    // (offset of the bucket from curr_bucket, vertex)
+    typedef pair<size_t, uintV> BucketEntry;
+    BucketEntry *entries = newA(BucketEntry, k);
+    BucketEntry *queued = newA(BucketEntry, k);
+    bool *flags = newA(bool, k);
+    parallel_for(0, k, [&](long i) {
+      uintV v = improved_vertices[i];
+      size_t bucket = requeueImproved(v, curr_bucket);
+      flags[i] = (bucket != NO_BUCKET);
+      entries[i] = make_pair(bucket - curr_bucket, v);
+    });
+    long count = sequence::pack(entries, queued, flags, k);
+    if (count > 0) {
+      size_t max_offset = sequence::reduce<size_t>(
+          (long)0, count, maxF<size_t>(),
+          [&](long i) -> size_t { return queued[i].first; });
+      // The radix sort is stable, so each bucket gets its vertices in the
+      // order they were improved
+      intSort::iSort(queued, count, (long)max_offset + 1,
+                     [&](BucketEntry e) -> long { return e.first; });
+      parallel_for(0, count, [&](long i) {
+        flags[i] = (i == 0) || (queued[i].first != queued[i - 1].first);
+      });
+      _seq<long> firsts = sequence::packIndex<long>(flags, count);
+      if (buckets.size() <= curr_bucket + max_offset) {
+        buckets.resize(curr_bucket + max_offset + 1);
+      }
+      parallel_for(0, firsts.n, [&](long j) {
+        long first = firsts.A[j];
+        long last = (j + 1 < firsts.n) ? firsts.A[j + 1] : count;
+        vector<uintV> &bucket = buckets[curr_bucket + queued[first].first];
+        size_t size = bucket.size();
+        bucket.resize(size + (last - first));
+        parallel_for(first, last, [&](long i) {
+          bucket[size + (i - first)] = queued[i].second;
+        });
+      });
+      firsts.del();
+    }
+    free(entries);
+    free(queued);
+    free(flags);
+  }
+
+  // Moves the vertices of the first non-empty bucket >= curr_bucket to
+  // frontier_vertices. Returns false if all the buckets are empty.
+  bool nextBucket(size_t &curr_bucket, vector<uintV> &frontier_vertices) {
+    while (curr_bucket < buckets.size() && buckets[curr_bucket].empty()) {
+      curr_bucket++;
+    }
+    if (curr_bucket == buckets.size()) {
+      return false;
+    }
+    frontier_vertices.clear();
+    frontier_vertices.swap(buckets[curr_bucket]);
+    return true;
+  }
+
+  // Delta-stepping: the scheduled vertices are processed in buckets of
+  // priorities [b * delta, (b + 1) * delta), smallest first. A vertex that
+  // improves goes to its new bucket, or back to the current bucket, so most
+  // vertices are only processed once their value is final. An entry of a
+  // vertex that has since moved to another bucket is stale: only the entry
+  // that resets queued_bucket[u] from the current bucket processes u.
+  void bucketedIncrementalComputation() {
+    forEachScheduled([&](uintV v) { markImproved(v); });
+    active_vertices_bitset.reset();
+
+    size_t curr_bucket = 0;
+    queueImproved(curr_bucket);
+    vector<uintV> frontier_vertices;
+    while (nextBucket(curr_bucket, frontier_vertices)) {
+      parallel_for(0, (long)frontier_vertices.size(), [&](long j) {
+        uintV u = frontier_vertices[j];
+        if (queued_bucket[u] != curr_bucket ||
+            !CAS(&queued_bucket[u], curr_bucket, NO_BUCKET)) {
+          return;
+        }
+        intE outDegree = my_graph.V[u].getOutDegree();
+        granular_for(i, 0, outDegree, (outDegree > 1024), {
+          uintV v = my_graph.V[u].getOutNeighbor(i);
+#ifdef EDGEDATA
+          EdgeData *edge_data = my_graph.V[u].getOutEdgeData(i);
+#else
+          EdgeData *edge_data = &emptyEdgeData;
+#endif
+          bool ret = reduce(u, v, *edge_data, dependency_data[u], dependency_data[v],
+                            global_info);
+          if (ret) {
+            markImproved(v);
+          }
+        });
+      });
+      queueImproved(curr_bucket);
+    }
+  }
+
   void traditionalIncrementalComputation() {
-    while (active_vertices_bitset.anyScheduledTasks()) {
-      active_vertices_bitset.newIteration();
-      parallel_for(uintV u = 0; u < n; u++) {
-        if (active_vertices_bitset.isScheduled(u)) {
+    if (bucket_delta > 0) {
+      bucketedIncrementalComputation();
+    } else {
+      while (active_vertices_bitset.anyScheduledTasks()) {
+        active_vertices_bitset.newIteration();
+        forEachScheduled([&](uintV u) {
           // process all its outNghs
           intE outDegree = my_graph.V[u].getOutDegree();
           granular_for(i, 0, outDegree, (outDegree > 1024), {
@@ -373,9 +847,14 @@ public:
               active_vertices_bitset.schedule(v);
             }
           });
-        }
+        });
       }
     }
+    if (level_overflow) {
+      cout << "ERROR : Dependency tree deeper than " << max_level - 1
+           << " levels. Rebuild with DEEPTREES=1\n";
+      exit(1);
+    }
   }
 
   void deltaCompute(edgeArray &edge_additions, edgeArray &edge_deletions) {
@@ -389,16 +868,9 @@ public:
       processVertexAddition(edge_additions.maxVertex);
     }
 
-    // Reset values before incremental computation
-    active_vertices_bitset.reset();
-    parallel_for(uintV v = 0; v < n; v++) {
-      frontier[v] = 0;
-      // all_affected_vertices is used only for switching purposes
-      all_affected_vertices[v] = 0;
-      changed[v] = 0;
-      // Make a copy of the old dependency data
-      dependency_data_old[v] = dependency_data[v];
-    }
+    // Reset values before incremental computation. The vertex subsets are
+    // already clear, and the old dependency data is copied on first write.
+    newEpoch();
 
     // ======================================================================
     // PHASE 1 - Update global_info
@@ -411,68 +883,80 @@ public:
     // PHASE 2 = Identify vertex values affected by edge deletions
     // ======================================================================
     bool frontier_not_empty = false;
-    parallel_for(long i = 0; i < edge_deletions.size; i++) {
+    parallel_for(0, edge_deletions.size, [&](long i) {
       uintV source = edge_deletions.E[i].source;
       uintV destination = edge_deletions.E[i].destination;
       if (dependency_data[destination].parent == source) {
+        saveOldDependencyData(destination);
         dependency_data[destination].reset();
         initializeVertexValue<VertexValueType, GlobalInfoType>(
             destination, dependency_data[destination].value, global_info);
-        active_vertices_bitset.schedule(destination);
-        all_affected_vertices[destination] = true;
+        scheduleTrim(destination);
+        markAffected(destination);
       }
-    }
+    });
 
     // ======================================================================
     // PHASE 3 - Trimming phase
     // ======================================================================
+    // Each round only goes through the vertices queued by the previous one,
+    // so trimming costs O(size of the trimmed subtrees) rather than O(n) per
+    // level.
     bool should_switch_now = false;
     bool use_delta = true;
-    while (active_vertices_bitset.anyScheduledTasks()) {
+    while (trim_next_count > 0) {
+      swap(trim_curr, trim_next);
+      trim_curr_count = trim_next_count;
+      trim_next_count = 0;
+      parallel_for(0, trim_curr_count,
+                   [&](long j) { trim_queued[trim_curr[j]] = 0; });
 
       // For all the vertices 'v' affected, update value of 'v' from its
       // inNghs, such that level(v) > level(inNgh) in the old dependency tree
-      active_vertices_bitset.newIteration();
-      parallel_for(uintV v = 0; v < n; v++) {
-        if (active_vertices_bitset.isScheduled(v)) {
-          intE inDegree = my_graph.V[v].getInDegree();
-          DependencyData<VertexValueType> v_value_old = dependency_data[v];
-          parallel_for(intE i = 0; i < inDegree; i++) {
-            uintV u = my_graph.V[v].getInNeighbor(i);
-            // Process inEdges with smallerLevel than currentVertex.
-            if (dependency_data_old[v].level > dependency_data_old[u].level) {
+      parallel_for(0, trim_curr_count, [&](long j) {
+        uintV v = trim_curr[j];
+        intE inDegree = my_graph.V[v].getInDegree();
+        DependencyData<VertexValueType> v_value_old = dependency_data[v];
+        const DependencyData<VertexValueType> &v_data_old =
+            oldDependencyData(v);
+        parallel_for(0, inDegree, [&](intE i) {
+          uintV u = my_graph.V[v].getInNeighbor(i);
+          // Process inEdges with smallerLevel than currentVertex.
+          if (v_data_old.level > oldDependencyData(u).level) {
 #ifdef EDGEDATA
-              EdgeData *edge_data = my_graph.V[v].getInEdgeData(i);
+            EdgeData *edge_data = my_graph.V[v].getInEdgeData(i);
 #else
-              EdgeData *edge_data = &emptyEdgeData;
+            EdgeData *edge_data = &emptyEdgeData;
 #endif
-              bool ret =
-                  reduce(u, v, *edge_data, dependency_data[u], v_value_old, global_info);
-            }
-          }
-          // Evaluate the shouldReduce condition.. See if the new value is
-          // greater than the old value
-          if ((shouldPropagate(dependency_data_old[v].value,
-                               dependency_data[v].value, global_info)) ||
-              (shouldPropagate(v_value_old.value, dependency_data[v].value,
-                               global_info))) {
-            changed[v] = 1;
+            bool ret =
+                reduce(u, v, *edge_data, dependency_data[u], v_value_old, global_info);
           }
+        });
+        // Evaluate the shouldReduce condition.. See if the new value is
+        // greater than the old value
+        if ((shouldPropagate(v_data_old.value, dependency_data[v].value,
+                             global_info)) ||
+            (shouldPropagate(v_value_old.value, dependency_data[v].value,
+                             global_info))) {
+          changed[v] = 1;
         }
-      }
+      });
 
-      parallel_for(uintV v = 0; v < n; v++) {
+      // The changed vertices are all in trim_curr
+      parallel_for(0, trim_curr_count, [&](long j) {
+        uintV v = trim_curr[j];
         if (changed[v]) {
           changed[v] = 0;
           // Push down in dependency tree
           intE outDegree = my_graph.V[v].getOutDegree();
           DependencyData<VertexValueType> v_value = dependency_data[v];
-          parallel_for(intE i = 0; i < outDegree; i++) {
+          parallel_for(0, outDegree, [&](intE i) {
             uintV w = my_graph.V[v].getOutNeighbor(i);
             // Push the changes down only to its outNghs in the dependency
             // tree
             if (dependency_data[w].parent == v) {
               DependencyData<VertexValueType> newV, oldV;
+              saveOldDependencyData(w);
               oldV = dependency_data[w];
 
               // Reset dependency_data[w]
@@ -491,47 +975,46 @@ public:
 
               if ((oldV.value != newV.value) || (oldV.level != newV.level)) {
                 dependency_data[w] = newV;
-                all_affected_vertices[w] = true;
+                markAffected(w);
 
-                if ((shouldPropagate(dependency_data_old[w].value, newV.value,
+                if ((shouldPropagate(oldDependencyData(w).value, newV.value,
                                      global_info)) ||
                     (shouldPropagate(oldV.value, newV.value, global_info))) {
-                  active_vertices_bitset.schedule(w);
+                  scheduleTrim(w);
                 }
                 if (shouldPropagate(oldV.value, newV.value, global_info)) {
                   frontier[w] = 1;
                 }
               }
             }
-          }
+          });
         }
-      }
+      });
       bool *temp = changed;
       changed = frontier;
       frontier = temp;
     }
 
     // Pull once for all the affected vertices
-    parallel_for(uintV v = 0; v < n; v++) {
-      if (all_affected_vertices[v] == 1) {
-        intE inDegree = my_graph.V[v].getInDegree();
-        parallel_for(intE i = 0; i < inDegree; i++) {
-          uintV u = my_graph.V[v].getInNeighbor(i);
+    parallel_for(0, affected_count, [&](long j) {
+      uintV v = affected_vertices[j];
+      intE inDegree = my_graph.V[v].getInDegree();
+      parallel_for(0, inDegree, [&](intE i) {
+        uintV u = my_graph.V[v].getInNeighbor(i);
 #ifdef EDGEDATA
-          EdgeData *edge_data = my_graph.V[v].getInEdgeData(i);
+        EdgeData *edge_data = my_graph.V[v].getInEdgeData(i);
 #else
-          EdgeData *edge_data = &emptyEdgeData;
+        EdgeData *edge_data = &emptyEdgeData;
 #endif
-          bool ret =
-              reduce(u, v, *edge_data, dependency_data[u], dependency_data[v], global_info);
-        }
-      }
-    }
+        bool ret =
+            reduce(u, v, *edge_data, dependency_data[u], dependency_data[v], global_info);
+      });
+    });
 
     // ======================================================================
     // PHASE 4 - Process additions
     // ======================================================================
-    parallel_for(long i = 0; i < edge_additions.size; i++) {
+    parallel_for(0, edge_additions.size, [&](long i) {
       uintV source = edge_additions.E[i].source;
       uintV destination = edge_additions.E[i].destination;
 #ifdef EDGEDATA
@@ -542,20 +1025,19 @@ public:
       bool ret = reduce(source, destination, *edge_data, dependency_data[source],
                         dependency_data[destination], global_info);
       if (ret) {
-        all_affected_vertices[destination] = true;
+        markAffected(destination);
       }
-    }
+    });
 
     // ======================================================================
     // PHASE 5 - Traditional processing
     // ======================================================================
     // For all affected vertices, start traditional processing
     active_vertices_bitset.reset();
-    parallel_for(uintV v = 0; v < n; v++) {
-      if (all_affected_vertices[v] == 1) {
-        active_vertices_bitset.schedule(v);
-      }
-    }
+    parallel_for(0, affected_count, [&](long j) {
+      active_vertices_bitset.schedule(affected_vertices[j]);
+    });
+    clearAffected();
     traditionalIncrementalComputation();
 
     cout << "Finished batch : " << full_timer.stop() << "\n";
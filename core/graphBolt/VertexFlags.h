@@ -0,0 +1,202 @@
+// Copyright (c) 2020 Mugilan Mariappan, Joanna Che and Keval Vora.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef __VERTEX_FLAGS_H__
+#define __VERTEX_FLAGS_H__
+
+#include "../common/densebitset.h"
+#include "../common/utils.h"
+
+// One flag per vertex, used by the GraphBolt engine for its frontiers and
+// its changed vertices. flags[v] reads and writes the flag of v, and writes
+// to different vertices can happen in parallel.
+//
+// BoolVertexFlags uses one byte per vertex. BitsetVertexFlags uses one bit
+// per vertex (8x less memory), and skips 64 vertices at a time when counting
+// or iterating over the set flags. It is selected by compiling with
+// -DBITSET_FRONTIERS. Its writes are atomic, so they are only done when the
+// flag actually changes.
+
+// ======================================================================
+// BOOLVERTEXFLAGS
+// ======================================================================
+class BoolVertexFlags {
+  bool *flags;
+  long n;
+
+public:
+  BoolVertexFlags() : flags(nullptr), n(0) {}
+
+  void create(long _n) {
+    n = _n;
+    flags = newA(bool, n);
+  }
+  void resize(long n_new) {
+    flags = renewA(bool, flags, n_new);
+    n = n_new;
+  }
+  void del() { deleteA(flags); }
+
+  inline bool &operator[](long v) { return flags[v]; }
+  inline bool operator[](long v) const { return flags[v]; }
+
+  // Sets the flag of v. Returns true if it was not set before this call.
+  inline bool testAndSet(long v) {
+    return !flags[v] && CAS(&flags[v], false, true);
+  }
+
+  void fill(long start, long end, bool value) {
+    parallel_for(start, end, [&](long v) { flags[v] = value; });
+  }
+
+  long count() const { return sequence::sum(flags, n); }
+  bool any() const { return count() != 0; }
+
+  // Sum of the out-degrees of the vertices with a set flag
+  template <class vertex> long outDegreeSum(vertex *V) const {
+    return sequence::plusReduceDegree(V, flags, n);
+  }
+
+  // Applies f to the vertices with a set flag, in parallel
+  template <class F> void forEach(F f) const {
+    parallel_for(0, n, [&](uintV v) {
+      if (flags[v])
+        f(v);
+    });
+  }
+};
+
+// ======================================================================
+// BITSETVERTEXFLAGS
+// ======================================================================
+class BitsetVertexFlags {
+  DenseBitset *bits;
+
+  static const long bits_per_word = 8 * sizeof(IdType);
+
+  // Calls f(v) for the set bits of word i
+  template <class F> static inline void forEachBit(IdType word, long i, F f) {
+    while (word != 0) {
+      f((uintV)(i * bits_per_word + __builtin_ctzll(word)));
+      word &= word - 1;
+    }
+  }
+
+public:
+  class Reference {
+    DenseBitset *bits;
+    long v;
+
+  public:
+    Reference(DenseBitset *_bits, long _v) : bits(_bits), v(_v) {}
+    inline operator bool() const { return bits->get(v); }
+    inline Reference &operator=(bool value) {
+      if (bits->get(v) != value) {
+        bits->set(v, value);
+      }
+      return *this;
+    }
+    inline Reference &operator=(const Reference &other) {
+      return *this = (bool)other;
+    }
+  };
+
+  BitsetVertexFlags() : bits(nullptr) {}
+
+  void create(long n) { bits = new DenseBitset(n); }
+  void resize(long n_new) {
+    long words_old = bits->numWords();
+    bits->resize(n_new);
+    IdType *words = bits->getArray();
+    for (long i = words_old; i < (long)bits->numWords(); i++) {
+      words[i] = 0;
+    }
+  }
+  void del() { delete bits; }
+
+  inline Reference operator[](long v) { return Reference(bits, v); }
+  inline bool operator[](long v) const { return bits->get(v); }
+
+  // Sets the flag of v. Returns true if it was not set before this call.
+  inline bool testAndSet(long v) { return !bits->get(v) && !bits->setBit(v); }
+
+  void fill(long start, long end, bool value) {
+    if (start >= end) {
+      return;
+    }
+    IdType *words = bits->getArray();
+    long first_word = start / bits_per_word;
+    long last_word = (end - 1) / bits_per_word;
+    parallel_for(first_word, last_word + 1, [&](long i) {
+      IdType mask = ~(IdType)0;
+      if (i == first_word) {
+        mask &= ~(IdType)0 << (start % bits_per_word);
+      }
+      if (i == last_word && end % bits_per_word != 0) {
+        mask &= ~(~(IdType)0 << (end % bits_per_word));
+      }
+      // The first and the last word can be shared with other vertices
+      if (value) {
+        __sync_fetch_and_or(&words[i], mask);
+      } else {
+        __sync_fetch_and_and(&words[i], ~mask);
+      }
+    });
+  }
+
+  long count() const {
+    const IdType *words = bits->getArray();
+    return sequence::reduce<long>((long)0, (long)bits->numWords(),
+                                  addF<long>(), [&](long i) -> long {
+                                    return __builtin_popcountll(words[i]);
+                                  });
+  }
+  bool any() const { return count() != 0; }
+
+  template <class vertex> long outDegreeSum(vertex *V) const {
+    const IdType *words = bits->getArray();
+    return sequence::reduce<long>((long)0, (long)bits->numWords(),
+                                  addF<long>(), [&](long i) -> long {
+                                    long degrees = 0;
+                                    forEachBit(words[i], i, [&](uintV v) {
+                                      degrees += V[v].getOutDegree();
+                                    });
+                                    return degrees;
+                                  });
+  }
+
+  template <class F> void forEach(F f) const {
+    const IdType *words = bits->getArray();
+    parallel_for(0, (long)bits->numWords(), [&](long i) {
+      if (words[i] != 0) {
+        forEachBit(words[i], i, f);
+      }
+    });
+  }
+};
+
+#ifdef BITSET_FRONTIERS
+typedef BitsetVertexFlags VertexFlags;
+#else
+typedef BoolVertexFlags VertexFlags;
+#endif
+
+#endif
@@ -0,0 +1,165 @@
+// Copyright (c) 2020 Mugilan Mariappan, Joanna Che and Keval Vora.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights (to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "../graph/IO.h"
+#include "../graph/graph.h"
+#include <cstdio>
+#include <string>
+
+// A checkpoint taken after a batch is made of two files:
+//
+//   <prefix>.graph : snapshot of the graph (see graphSnapshot.h). main.h
+//                    loads it in place of the input graph with -restore.
+//   <prefix>.state : CheckpointHeader, followed by the dependency data of
+//                    the engine as raw arrays of n values.
+//
+// Each file is written to <file>.tmp, synced and renamed over the previous
+// one, the graph first. The ingestor batch of the checkpoint is stored in both
+// headers (as the generation of the snapshot), so a restore from a checkpoint
+// that was interrupted between the two renames is detected.
+#define CHECKPOINT_MAGIC "GBCHKPNT"
+#define CHECKPOINT_MAGIC_SIZE 8
+#define CHECKPOINT_VERSION 2
+
+enum CheckpointEngine { graphbolt_checkpoint = 1, kickstarter_checkpoint = 2 };
+
+struct CheckpointHeader {
+  char magic[CHECKPOINT_MAGIC_SIZE];
+  uint32_t version;
+  uint32_t engine;
+  uint64_t n;
+  uint64_t m;
+  uint32_t aggregation_value_size; // 0 for KickStarter
+  uint32_t vertex_value_size;
+  int32_t history_iterations;
+  int32_t converged_iteration;
+  int64_t engine_batch;
+  int64_t ingestor_batch;
+  // Position in the stream after the last batch. -1 if the stream had been
+  // fully consumed.
+  int64_t stream_position;
+
+  CheckpointHeader() { memset(this, 0, sizeof(CheckpointHeader)); }
+
+  CheckpointHeader(CheckpointEngine _engine) : CheckpointHeader() {
+    memcpy(magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE);
+    version = CHECKPOINT_VERSION;
+    engine = _engine;
+  }
+
+  bool isValid() const {
+    return memcmp(magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE) == 0 &&
+           version == CHECKPOINT_VERSION;
+  }
+};
+
+inline string checkpointGraphPath(const string &prefix) {
+  return prefix + ".graph";
+}
+
+inline string checkpointStatePath(const string &prefix) {
+  return prefix + ".state";
+}
+
+template <class T>
+inline bool writeCheckpointArray(FILE *f, const T *A, long count) {
+  return fwrite(A, sizeof(T), count, f) == (size_t)count;
+}
+
+template <class T> inline bool readCheckpointArray(FILE *f, T *A, long count) {
+  return fread(A, sizeof(T), count, f) == (size_t)count;
+}
+
+// Writes the graph part of the checkpoint described by header. Returns false
+// on failure.
+template <class vertex>
+bool writeCheckpointGraph(graph<vertex> &G, const string &prefix,
+                          const CheckpointHeader &header) {
+  string path = checkpointGraphPath(prefix);
+  string tmp_path = path + ".tmp";
+  return writeGraphSnapshot(G, tmp_path.c_str(),
+                            (uint32_t)header.ingestor_batch) &&
+         rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+// Opens <prefix>.state.tmp and writes the header. The engine then writes its
+// arrays and calls commitCheckpointState().
+inline FILE *beginCheckpointState(const string &prefix,
+                                  const CheckpointHeader &header) {
+  string tmp_path = checkpointStatePath(prefix) + ".tmp";
+  FILE *f = fopen(tmp_path.c_str(), "wb");
+  if (f != NULL && fwrite(&header, sizeof(CheckpointHeader), 1, f) != 1) {
+    fclose(f);
+    return NULL;
+  }
+  return f;
+}
+
+inline bool commitCheckpointState(FILE *f, const string &prefix,
+                                  bool success) {
+  string path = checkpointStatePath(prefix);
+  string tmp_path = path + ".tmp";
+  success = success && (fflush(f) == 0) && (fsync(fileno(f)) == 0);
+  success = (fclose(f) == 0) && success;
+  return success && rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+// Opens <prefix>.state and reads its header. Exits if the file can not be
+// used to restore an engine of the given kind on the checkpoint graph of n
+// vertices and m edges.
+inline FILE *openCheckpointState(const string &prefix,
+                                 CheckpointHeader &header,
+                                 CheckpointEngine engine, long n, long m) {
+  string path = checkpointStatePath(prefix);
+  FILE *f = fopen(path.c_str(), "rb");
+  if (f == NULL) {
+    std::cerr << "Unable to open checkpoint " << path << "\n";
+    exit(1);
+  }
+  if (fread(&header, sizeof(CheckpointHeader), 1, f) != 1 ||
+      !header.isValid() || header.engine != engine) {
+    std::cerr << "Invalid checkpoint " << path << "\n";
+    exit(1);
+  }
+  if (header.n != (uint64_t)n || header.m != (uint64_t)m) {
+    std::cerr << "Checkpoint " << path << " does not match "
+              << checkpointGraphPath(prefix) << " (n = " << header.n
+              << ", m = " << header.m << " in state, n = " << n
+              << ", m = " << m << " in graph)\n";
+    exit(1);
+  }
+  GraphSnapshotHeader graph_header;
+  if (!readGraphSnapshotHeader(checkpointGraphPath(prefix).c_str(),
+                               graph_header) ||
+      graph_header.generation != (uint32_t)header.ingestor_batch) {
+    std::cerr << "Checkpoint " << path << " does not match "
+              << checkpointGraphPath(prefix) << " (batch "
+              << header.ingestor_batch << " in state, batch "
+              << graph_header.generation << " in graph)\n";
+    exit(1);
+  }
+  return f;
+}
+
+#endif
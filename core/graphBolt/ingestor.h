@@ -22,12 +22,14 @@
 #ifndef INGESTOR_H
 #define INGESTOR_H
 
+#include "../common/blockRadixSort.h"
 #include "../common/parseCommandLine.h"
 #include "../common/utils.h"
 #include "../graph/IO.h"
+#include "../graph/edgeStreamFormat.h"
 #include "../graph/graph.h"
-#include <string>
 #include <sstream>
+#include <string>
 
 /**
  * Used to extract values from the binary stream
@@ -36,6 +38,7 @@ struct StreamEdge {
   uintV source;
   uintV destination;
   char edgeType;
+  const char *edgeData; // points into the read buffer
 };
 
 // TODO : Determine what should be abstracted and stuff
@@ -64,8 +67,33 @@ public:
   bool fixed_batch_flag;
   bool enforce_edge_validity_flag;
   bool debug_flag;
+  bool binary_stream_flag;
+  bool memory_report_flag;
   bool stream_closed = false;
 
+  EdgeStreamHeader stream_header;
+  char *stream_buffer = nullptr;
+
+  // With -pipelineIngestion, the next batch is read, sorted and validated by
+  // prefetch_task while the engine computes on the current batch (see
+  // AsyncTask in parallel.h). The prefetched batch is held in the next_*
+  // buffer until processNextBatch(), which also prints next_read_log, so the
+  // messages of the reading do not interleave with those of the engine.
+  bool pipeline_flag;
+  bool prefetch_pending = false;
+  AsyncTask prefetch_task;
+  edgeArray next_edge_additions;
+  edgeArray next_edge_deletions;
+  long next_num_edges_read = 0;
+  long next_num_cancelled_edges = 0;
+  double next_reading_time = 0;
+  std::ostringstream next_read_log;
+
+  // Position in the stream after the batch last applied to the graph, -1 once
+  // the stream is closed. Saved by the engines' checkpoints.
+  long stream_position = 0;
+  long next_stream_position = 0;
+
   Ingestor(graph<vertex> &_my_graph, commandLine _config)
       : my_graph(_my_graph), config(_config), n(_my_graph.n),
         deletions_data(_my_graph.n), current_batch(0) {
@@ -78,6 +106,9 @@ public:
     fixed_batch_flag = config.getOptionValue("-fixedBatchSize");
     enforce_edge_validity_flag = config.getOptionValue("-enforceEdgeValidity");
     debug_flag = config.getOptionValue("-debug");
+    binary_stream_flag = config.getOptionValue("-binaryStream");
+    pipeline_flag = config.getOptionValue("-pipelineIngestion");
+    memory_report_flag = config.getOptionValue("-memoryReport");
     max_batch_size = config.getOptionLongValue("-nEdges", 0);
     if (max_batch_size == 0) {
       std::cout
@@ -90,6 +121,11 @@ public:
   }
 
   ~Ingestor() {
+    if (prefetch_pending) {
+      prefetch_task.join();
+      next_edge_additions.del();
+      next_edge_deletions.del();
+    }
     if (current_batch > number_of_batches) {
       edge_deletions.del();
     } else {
@@ -97,6 +133,8 @@ public:
     }
     edge_additions.del();
     stream_file.close();
+    if (stream_buffer != nullptr)
+      free(stream_buffer);
     deletions_data.del();
     if (n > 0)
       free(updated_vertices);
@@ -136,8 +174,233 @@ public:
       }
     }
     cout << "Opening Stream: Waiting for writer to open..." << endl;
-    stream_file.open(stream_path);
+    if (binary_stream_flag) {
+      stream_file.open(stream_path, ios::in | ios::binary);
+    } else {
+      stream_file.open(stream_path);
+    }
     cout << "Stream opened" << endl;
+    if (binary_stream_flag) {
+      readStreamHeader();
+    }
+  }
+
+  // Continues the stream after the batches applied before a checkpoint.
+  // Regular files are seeked to the saved position. A fifo can not be
+  // seeked, so its writer has to resume from the next batch itself.
+  void resumeStream(long batches_done, long position) {
+    current_batch = batches_done;
+    if (position < 0) {
+      stream_file.seekg(0, ios::end);
+    } else {
+      stream_file.seekg(position);
+    }
+    if (stream_file.fail()) {
+      stream_file.clear();
+      cout << "WARNING: Stream is not seekable. Expecting batch "
+           << batches_done + 1 << " as the next update" << endl;
+    } else {
+      cout << "Resuming stream after batch " << batches_done << endl;
+    }
+    stream_position = position;
+  }
+
+  void readStreamHeader() {
+    stream_file.read((char *)&stream_header, sizeof(EdgeStreamHeader));
+    if (stream_file.gcount() < (long)sizeof(EdgeStreamHeader) ||
+        !stream_header.isValid()) {
+      std::cerr << "Invalid binary stream header in " << stream_path
+                << std::endl;
+      exit(1);
+    }
+#ifdef EDGEDATA
+    if (stream_header.edge_data_width != sizeof(EdgeData)) {
+      std::cerr << "Binary stream does not contain edge data of this "
+                   "application ("
+                << stream_header.edge_data_width << " bytes per edge, expected "
+                << sizeof(EdgeData) << ")" << std::endl;
+      exit(1);
+    }
+#endif
+    cout << "Binary stream: vertex width = " << stream_header.vertex_width
+         << ", edge data width = " << stream_header.edge_data_width << endl;
+    stream_buffer = newA(char, max_batch_size * stream_header.recordSize());
+  }
+
+  // Reads up to maxRecords records of the binary stream into stream_buffer
+  // and returns the number of complete records read. Unless fixedBatchFlag is
+  // set, only the records already present in the stream are consumed (after
+  // blocking for the first one). Records are read in bulk: once the stream
+  // buffer is drained, in_avail() reports what is pending in the pipe, so a
+  // batch takes a couple of read() calls instead of one per edge.
+  long readStreamRecords(ifstream &inputFile, long maxRecords,
+                         bool fixedBatchFlag, bool &streamClosed) {
+    long recordSize = stream_header.recordSize();
+    long recordsRead = 0;
+    if (maxRecords <= 0) {
+      return 0;
+    }
+    if (!fixedBatchFlag && inputFile.rdbuf()->in_avail() <= 0) {
+      cout << "No Edges in Stream: Waiting for more edges or for stream "
+              "to close"
+           << endl;
+    }
+    long bytesPending = 0;
+    do {
+      long recordsToRead = maxRecords - recordsRead;
+      if (!fixedBatchFlag && recordsRead > 0) {
+        // A partially received record is waited for.
+        recordsToRead =
+            min(recordsToRead, (bytesPending + recordSize - 1) / recordSize);
+      } else if (!fixedBatchFlag) {
+        recordsToRead = 1;
+      }
+      inputFile.read(stream_buffer + recordsRead * recordSize,
+                     recordsToRead * recordSize);
+      long bytesRead = inputFile.gcount();
+      recordsRead += bytesRead / recordSize;
+      if (bytesRead < recordsToRead * recordSize) {
+        streamClosed = true;
+        break;
+      }
+    } while (!fixedBatchFlag && recordsRead < maxRecords &&
+             (bytesPending = inputFile.rdbuf()->in_avail()) > 0);
+    return recordsRead;
+  }
+
+  static uintV batchSource(const intPair &e) { return e.first; }
+  static uintV batchDestination(const intPair &e) { return e.second; }
+#ifdef EDGEDATA
+  static uintV batchSource(const intWeights &e) { return e.first; }
+  static uintV batchDestination(const intWeights &e) { return e.second.first; }
+#endif
+  static uintV batchSource(const edge &e) { return e.source; }
+  static uintV batchDestination(const edge &e) { return e.destination; }
+
+  static void relabelBatch(const VertexOrder &order, intPair *edges,
+                           long count) {
+    parallel_for(0, count, [&](long i) {
+      edges[i].first = order.internalId(edges[i].first);
+      edges[i].second = order.internalId(edges[i].second);
+    });
+  }
+#ifdef EDGEDATA
+  static void relabelBatch(const VertexOrder &order, intWeights *edges,
+                           long count) {
+    parallel_for(0, count, [&](long i) {
+      edges[i].first = order.internalId(edges[i].first);
+      edges[i].second.first = order.internalId(edges[i].second.first);
+    });
+  }
+#endif
+
+  template <class E> static bool batchLess(const E &a, const E &b) {
+    if (batchSource(a) != batchSource(b)) {
+      return batchSource(a) < batchSource(b);
+    }
+    return batchDestination(a) < batchDestination(b);
+  }
+
+  template <class E> static bool batchEqual(const E &a, const E &b) {
+    return batchSource(a) == batchSource(b) &&
+           batchDestination(a) == batchDestination(b);
+  }
+
+  // Number of bits of the largest vertex id in edges[0, count)
+  template <class E> static int batchVertexBits(E *edges, long count) {
+    if (count == 0) {
+      return 0;
+    }
+    long maxId = sequence::reduce<long>((long)0, count, maxF<long>(),
+                                        [&](long i) -> long {
+                                          return max(batchSource(edges[i]),
+                                                     batchDestination(edges[i]));
+                                        });
+    return log2Up(maxId + 1);
+  }
+
+  // Sorts edges[0, count) by source, then destination. The pair is packed
+  // as (source << bits | destination) and radix sorted, where bits covers
+  // every vertex id of the batch. Ids too wide to pack in a long fall back
+  // to quickSort.
+  template <class E, class Cmp>
+  static void sortBatch(E *edges, long count, int bits, Cmp cmp) {
+    if (2 * bits > 62) {
+      quickSort(edges, count, cmp);
+      return;
+    }
+    intSort::iSort(edges, count, 1L << (2 * bits), [&](E e) -> long {
+      return ((long)batchSource(e) << bits) | (long)batchDestination(e);
+    });
+  }
+
+  // Pairs the k-th copy of each edge of the sorted deletions ED with the k-th
+  // copy of the same edge in the sorted additions EA and flags both, as a
+  // merge of the two batches would. Returns the number of pairs.
+  template <class E, class P>
+  static long cancelBatch(E *EA, long EAcount, bool *EAflag, E *ED,
+                          long EDcount, bool *EDflag, P cancelled) {
+    parallel_for(0, EDcount, [&](long i) {
+      long copy = i - (lower_bound(ED, ED + i, ED[i], batchLess<E>) - ED);
+      long j = (lower_bound(EA, EA + EAcount, ED[i], batchLess<E>) - EA) + copy;
+      if (j < EAcount && batchEqual(EA[j], ED[i])) {
+        EAflag[j] = true;
+        EDflag[i] = true;
+        cancelled(i);
+      }
+    });
+    return sequence::reduce<long>((long)0, EDcount, addF<long>(),
+                                  [&](long i) -> long { return EDflag[i]; });
+  }
+
+  // Calls found(i) for each edge i of the batch edges[0, count), sorted by
+  // source and destination, that is already in the graph. Only the edges
+  // with considered(i) are looked up. Each source scans its adjacency once
+  // and binary searches its neighbors in its run of the batch. This costs
+  // O(degree * log(run)) per source instead of O(degree) per edge.
+  template <class E, class C, class F>
+  void forEachEdgeInGraph(graph<vertex> &GA, E *edges, long count,
+                          C considered, F found) {
+    bool *run_start = newA(bool, count);
+    parallel_for(0, count, [&](long i) {
+      run_start[i] = (i == 0) || (edges[i].first != edges[i - 1].first);
+    });
+    _seq<long> runs = sequence::packIndex<long>(run_start, count);
+    free(run_start);
+
+    parallel_for(0, runs.n, [&](long r) {
+      long start = runs.A[r];
+      long end = (r + 1 < runs.n) ? runs.A[r + 1] : count;
+      uintV source = edges[start].first;
+      bool any_considered = false;
+      for (long i = start; i < end; i++) {
+        any_considered = any_considered || considered(i);
+      }
+      if (source >= GA.n || !any_considered) {
+        return;
+      }
+      vertex &sourceV = GA.V[source];
+      intE degree = sourceV.getOutDegree();
+      granular_for(j, 0, degree, (degree > 1024), {
+        uintV ngh = sourceV.getOutNeighbor(j);
+        long lo = start;
+        long hi = end;
+        while (lo < hi) {
+          long mid = lo + (hi - lo) / 2;
+          if (batchDestination(edges[mid]) < ngh) {
+            lo = mid + 1;
+          } else {
+            hi = mid;
+          }
+        }
+        for (long i = lo; i < end && batchDestination(edges[i]) == ngh; i++) {
+          if (considered(i)) {
+            found(i);
+          }
+        }
+      });
+    });
+    runs.del();
   }
 
   tuple<edgeArray, edgeArray, long, long>
@@ -165,7 +428,6 @@ public:
 #endif
     char edgeType;
     string line;
-    vector<string> tokens;
     long lineCount = 0;
     uintV maxVertex = 0;
 
@@ -188,100 +450,167 @@ public:
     long cancelledEdges = 0;
 
     StreamEdge *edgesReceived = newA(StreamEdge, numEdges);
-    cout << "Batch Size: " << numEdges << endl;
+    next_read_log << "Batch Size: " << numEdges << endl;
     do {
       edgesToRead = numEdges - checkedEDCount - checkedEACount;
       if (debugFlag) {
-        cout << "Edges Added: " << checkedEACount << endl;
-        cout << "Edges Deleted: " << checkedEDCount << endl;
-        cout << "Edges to be Read: " << edgesToRead << endl;
+        next_read_log << "Edges Added: " << checkedEACount << endl;
+        next_read_log << "Edges Deleted: " << checkedEDCount << endl;
+        next_read_log << "Edges to be Read: " << edgesToRead << endl;
       }
       uncheckedEACount = 0;
       uncheckedEDCount = 0;
-      for (long i = 0; i < edgesToRead; i++) {
-        long long numberOfBytesAvail = inputFile.rdbuf()->in_avail();
-        if (!fixedBatchFlag && numberOfBytesAvail <= 0) {
-          if (i == 0) {
-            cout << "No Edges in Stream: Waiting for more edges or for stream "
-                    "to close"
-                 << endl;
+      if (binary_stream_flag) {
+        long recordsRead = readStreamRecords(inputFile, edgesToRead,
+                                             fixedBatchFlag, streamClosed);
+        if (recordsRead < edgesToRead) {
+          edgesRead = recordsRead;
+          if (streamClosed) {
+            cout << "WARNING: Stream Closed. Only " << recordsRead
+                 << " edges read" << endl;
           } else {
-            edgesRead = i;
             cerr << "WARNING: Not enough edges to fulfill batch size. Only "
-                 << i << " edges read." << endl;
-            break;
+                 << recordsRead << " edges read." << endl;
           }
         }
-
-        std::getline(inputFile, line);
-        if ((line[0] == '%') || (line[0] == '#')) {
-          continue;
-        }
-
-        if (!inputFile.good()) {
-          edgesRead = i;
-          streamClosed = true;
-          cout << "WARNING: Stream Closed. Only " << i << " edges read" << endl;
-          break;
-        }
-        tokens.clear();
-        string buf;
-        stringstream ss(line);
-        while (ss >> buf) {
-          tokens.push_back(buf);
+        size_t recordSize = stream_header.recordSize();
+        bool badRecord = false;
+        parallel_for(0, recordsRead, [&](long i) {
+          uint64_t src, dst;
+          StreamEdge &e = edgesReceived[i];
+          decodeEdgeStreamRecord(stream_buffer + i * recordSize, stream_header,
+                                 e.edgeType, src, dst, e.edgeData);
+          e.source = src;
+          e.destination = dst;
+          if ((e.edgeType != 'a' && e.edgeType != 'd') || e.source != src ||
+              e.destination != dst) {
+            badRecord = true;
+          }
+        });
+        if (badRecord) {
+          std::cout << "Incorrect input format \n" << std::endl;
+          inputFile.close();
+          exit(1);
         }
+        for (long i = 0; i < recordsRead; i++) {
+          StreamEdge &e = edgesReceived[i];
 #ifdef EDGEDATA
-        if (tokens.size() == 4) {
-          edgeType = tokens[0].at(0);
-          source = stoi(tokens[1]);
-          destination = stoi(tokens[2]);
-
-          if (edgeType == 'a') {
-            new (edgeWeightEA + uncheckedEACount) EdgeData();
-            edgeWeightEA[uncheckedEACount].createEdgeData(tokens[3].c_str());
-            uncheckedEA[uncheckedEACount] =
-                make_pair(source, make_pair(destination,
-                                            &edgeWeightEA[uncheckedEACount]));
+          if (e.edgeType == 'a') {
+            memcpy(edgeWeightEA + uncheckedEACount, e.edgeData,
+                   sizeof(EdgeData));
+            uncheckedEA[uncheckedEACount] = make_pair(
+                e.source,
+                make_pair(e.destination, &edgeWeightEA[uncheckedEACount]));
             uncheckedEACount++;
-          } else if (edgeType == 'd') {
-            new (edgeWeightED + uncheckedEDCount) EdgeData();
-            edgeWeightED[uncheckedEDCount].createEdgeData(tokens[3].c_str());
-            uncheckedED[uncheckedEDCount] =
-                make_pair(source, make_pair(destination,
-                                            &edgeWeightED[uncheckedEDCount]));
+          } else {
+            memcpy(edgeWeightED + uncheckedEDCount, e.edgeData,
+                   sizeof(EdgeData));
+            uncheckedED[uncheckedEDCount] = make_pair(
+                e.source,
+                make_pair(e.destination, &edgeWeightED[uncheckedEDCount]));
             uncheckedEDCount++;
           }
-        }
 #else
-        if (tokens.size() == 3) {
-          edgeType = tokens[0].at(0);
-          source = stoi(tokens[1]);
-          destination = stoi(tokens[2]);
-
-          if (edgeType == 'a') {
-            uncheckedEA[uncheckedEACount] = make_pair(source, destination);
+          if (e.edgeType == 'a') {
+            uncheckedEA[uncheckedEACount] = make_pair(e.source, e.destination);
             uncheckedEACount++;
-          } else if (edgeType == 'd') {
-            uncheckedED[uncheckedEDCount] = make_pair(source, destination);
+          } else {
+            uncheckedED[uncheckedEDCount] = make_pair(e.source, e.destination);
             uncheckedEDCount++;
           }
+#endif
         }
+      } else {
+        for (long i = 0; i < edgesToRead; i++) {
+          long long numberOfBytesAvail = inputFile.rdbuf()->in_avail();
+          if (!fixedBatchFlag && numberOfBytesAvail <= 0) {
+            if (i == 0) {
+              cout << "No Edges in Stream: Waiting for more edges or for "
+                      "stream to close"
+                   << endl;
+            } else {
+              edgesRead = i;
+              cerr << "WARNING: Not enough edges to fulfill batch size. Only "
+                   << i << " edges read." << endl;
+              break;
+            }
+          }
+
+          std::getline(inputFile, line);
+          if ((line[0] == '%') || (line[0] == '#')) {
+            continue;
+          }
+
+          if (!inputFile.good()) {
+            edgesRead = i;
+            streamClosed = true;
+            cout << "WARNING: Stream Closed. Only " << i << " edges read"
+                 << endl;
+            break;
+          }
+          char *tokens[4];
+          int numTokens = splitTokens(&line[0], tokens, 4);
+#ifdef EDGEDATA
+          if (numTokens == 4) {
+            edgeType = tokens[0][0];
+            source = parseUnsigned<uintV>(tokens[1]);
+            destination = parseUnsigned<uintV>(tokens[2]);
+
+            if (edgeType == 'a') {
+              new (edgeWeightEA + uncheckedEACount) EdgeData();
+              edgeWeightEA[uncheckedEACount].createEdgeData(tokens[3]);
+              uncheckedEA[uncheckedEACount] =
+                  make_pair(source, make_pair(destination,
+                                              &edgeWeightEA[uncheckedEACount]));
+              uncheckedEACount++;
+            } else if (edgeType == 'd') {
+              new (edgeWeightED + uncheckedEDCount) EdgeData();
+              edgeWeightED[uncheckedEDCount].createEdgeData(tokens[3]);
+              uncheckedED[uncheckedEDCount] =
+                  make_pair(source, make_pair(destination,
+                                              &edgeWeightED[uncheckedEDCount]));
+              uncheckedEDCount++;
+            }
+          }
+#else
+          if (numTokens == 3) {
+            edgeType = tokens[0][0];
+            source = parseUnsigned<uintV>(tokens[1]);
+            destination = parseUnsigned<uintV>(tokens[2]);
+
+            if (edgeType == 'a') {
+              uncheckedEA[uncheckedEACount] = make_pair(source, destination);
+              uncheckedEACount++;
+            } else if (edgeType == 'd') {
+              uncheckedED[uncheckedEDCount] = make_pair(source, destination);
+              uncheckedEDCount++;
+            }
+          }
 #endif
-        else {
-          std::cout << "Incorrect input format \n" << std::endl;
-          inputFile.close();
-          exit(1);
+          else {
+            std::cout << "Incorrect input format \n" << std::endl;
+            inputFile.close();
+            exit(1);
+          }
         }
       }
       uncheckedEACountOrig = uncheckedEACount;
       uncheckedEDCountOrig = uncheckedEDCount;
 
+      // the stream uses the input ids (-reorder)
+      if (GA.order.isRelabeled()) {
+        relabelBatch(GA.order, uncheckedEA, uncheckedEACount);
+        relabelBatch(GA.order, uncheckedED, uncheckedEDCount);
+      }
+
+      int bits = max(batchVertexBits(uncheckedEA, uncheckedEACount),
+                     batchVertexBits(uncheckedED, uncheckedEDCount));
 #ifdef EDGEDATA
-      quickSort(uncheckedEA, uncheckedEACount, tripleBothCmp());
-      quickSort(uncheckedED, uncheckedEDCount, tripleBothCmp());
+      sortBatch(uncheckedEA, uncheckedEACount, bits, tripleBothCmp());
+      sortBatch(uncheckedED, uncheckedEDCount, bits, tripleBothCmp());
 #else
-      quickSort(uncheckedEA, uncheckedEACount, pairBothCmp<uintE>());
-      quickSort(uncheckedED, uncheckedEDCount, pairBothCmp<uintE>());
+      sortBatch(uncheckedEA, uncheckedEACount, bits, pairBothCmp<uintE>());
+      sortBatch(uncheckedED, uncheckedEDCount, bits, pairBothCmp<uintE>());
 #endif
 
       bool *EAflag = newAWithZero(bool, uncheckedEACount);
@@ -297,57 +626,25 @@ public:
       }
 
       if (!fixedBatchFlag) {
-        long eaIndex = 0;
-        long edIndex = 0;
-
         // remove values that cancel out
-        while (eaIndex < uncheckedEACount && edIndex < uncheckedEDCount) {
-#ifdef EDGEDATA
-          if (uncheckedEA[eaIndex].first == uncheckedED[edIndex].first &&
-              uncheckedEA[eaIndex].second.first ==
-                  uncheckedED[edIndex].second.first)
-#else
-          if (uncheckedEA[eaIndex].first == uncheckedED[edIndex].first &&
-              uncheckedEA[eaIndex].second == uncheckedED[edIndex].second)
-#endif
-          {
-            EAflag[eaIndex] = true;
-            EDflag[edIndex] = true;
-            if (debugFlag) {
-#ifdef EDGEDATA
-              cerr << "CANCELLED: " << uncheckedED[edIndex].first << "\t"
-                   << uncheckedED[edIndex].second.first << "\t"
-                   << uncheckedED[edIndex].second.second << "\n";
-#else
-              cerr << "CANCELLED: " << uncheckedED[edIndex].first << "\t"
-                   << uncheckedED[edIndex].second << "\n";
-#endif
-            }
-            eaIndex++;
-            edIndex++;
-            cancelledEdges++;
-          } else if (uncheckedEA[eaIndex].first == uncheckedED[edIndex].first) {
+        cancelledEdges += cancelBatch(
+            uncheckedEA, uncheckedEACount, EAflag, uncheckedED,
+            uncheckedEDCount, EDflag, [&](long i) {
+              if (debugFlag) {
 #ifdef EDGEDATA
-            if (uncheckedEA[eaIndex].second.first <
-                uncheckedED[edIndex].second.first)
+                cerr << "CANCELLED: " << uncheckedED[i].first << "\t"
+                     << uncheckedED[i].second.first << "\t"
+                     << uncheckedED[i].second.second << "\n";
 #else
-            if (uncheckedEA[eaIndex].second < uncheckedED[edIndex].second)
+                cerr << "CANCELLED: " << uncheckedED[i].first << "\t"
+                     << uncheckedED[i].second << "\n";
 #endif
-            {
-              eaIndex++;
-            } else {
-              edIndex++;
-            }
-          } else if (uncheckedEA[eaIndex].first < uncheckedED[edIndex].first) {
-            eaIndex++;
-          } else {
-            edIndex++;
-          }
-        }
+              }
+            });
       }
 
       // remove all EdgeDeletions >= G.n as they don't exist in the graph
-      parallel_for(long i = 0; i < uncheckedEDCount; i++) {
+      parallel_for(0, uncheckedEDCount, [&](long i) {
 #ifdef EDGEDATA
         if (uncheckedED[i].first >= GA.n ||
             uncheckedED[i].second.first >= GA.n) {
@@ -356,69 +653,59 @@ public:
 #endif
           EDflag[i] = true;
         }
-      }
+      });
 
       if (simpleFlag) {
         // check if edge additions edge is already in initial graph
         // we don't want the same edge from two vertices
-        parallel_for(long i = 0; i < uncheckedEACount; i++) {
-          if (EAflag[i] == false && uncheckedEA[i].first < GA.n) {
-            vertex sourceV = GA.V[uncheckedEA[i].first];
-            parallel_for(uintV j = 0; j < sourceV.getOutDegree(); j++) {
-#ifdef EDGEDATA
-              if (sourceV.getOutNeighbor(j) == uncheckedEA[i].second.first)
-#else
-              if (sourceV.getOutNeighbor(j) == uncheckedEA[i].second)
-#endif
-              {
-                EAflag[i] = true;
-                if (debugFlag) {
+        bool *EAcheck = newA(bool, uncheckedEACount);
+        parallel_for(0, uncheckedEACount,
+                     [&](long i) { EAcheck[i] = !EAflag[i]; });
+        forEachEdgeInGraph(
+            GA, uncheckedEA, uncheckedEACount,
+            [&](long i) { return EAcheck[i]; },
+            [&](long i) {
+              EAflag[i] = true;
+              if (debugFlag) {
 #ifdef EDGEDATA
-                  cerr << "INVALID: " << uncheckedEA[i].first << "\t"
-                       << uncheckedEA[i].second.first << "\t"
-                       << uncheckedEA[i].second.second << "\n";
+                cerr << "INVALID: " << uncheckedEA[i].first << "\t"
+                     << uncheckedEA[i].second.first << "\t"
+                     << uncheckedEA[i].second.second << "\n";
 #else
-                  cerr << "INVALID: " << uncheckedEA[i].first << "\t"
-                       << uncheckedEA[i].second << "\n";
+                cerr << "INVALID: " << uncheckedEA[i].first << "\t"
+                     << uncheckedEA[i].second << "\n";
 #endif
-                }
               }
-            }
-          }
-        }
+            });
+        free(EAcheck);
       }
 
       if (edgeValidityFlag) {
-        parallel_for(long i = 0; i < uncheckedEDCount; i++) {
-          // check if edge deletions is valid
-          if (EDflag[i] == false) {
-            EDflag[i] = true;
-            vertex sourceV = GA.V[uncheckedED[i].first];
-            // check if this edge is present in the graph
-            parallel_for(uintV j = 0; j < sourceV.getOutDegree(); j++) {
-#ifdef EDGEDATA
-              if (sourceV.getOutNeighbor(j) == uncheckedED[i].second.first)
-#else
-              if (sourceV.getOutNeighbor(j) == uncheckedED[i].second)
-#endif
-              {
-                EDflag[i] = false;
-              }
-            }
-            if (EDflag[i] == true) {
-              if (debugFlag) {
+        // check if edge deletions are present in the graph
+        bool *EDcheck = newA(bool, uncheckedEDCount);
+        parallel_for(0, uncheckedEDCount, [&](long i) {
+          EDcheck[i] = !EDflag[i];
+          EDflag[i] = true;
+        });
+        forEachEdgeInGraph(
+            GA, uncheckedED, uncheckedEDCount,
+            [&](long i) { return EDcheck[i]; },
+            [&](long i) { EDflag[i] = false; });
+        if (debugFlag) {
+          parallel_for(0, uncheckedEDCount, [&](long i) {
+            if (EDcheck[i] && EDflag[i]) {
 #ifdef EDGEDATA
-                cerr << "INVALID: " << uncheckedED[i].first << "\t"
-                     << uncheckedED[i].second.first << "\t"
-                     << uncheckedED[i].second.second << "\n";
+              cerr << "INVALID: " << uncheckedED[i].first << "\t"
+                   << uncheckedED[i].second.first << "\t"
+                   << uncheckedED[i].second.second << "\n";
 #else
-                cerr << "INVALID: " << uncheckedED[i].first << "\t"
-                     << uncheckedED[i].second << "\n";
+              cerr << "INVALID: " << uncheckedED[i].first << "\t"
+                   << uncheckedED[i].second << "\n";
 #endif
-              }
             }
-          }
+          });
         }
+        free(EDcheck);
       }
 
       long maxCount = max(uncheckedEACount, uncheckedEDCount);
@@ -458,8 +745,8 @@ public:
 
       // ensure there are no duplicates within the edges to add/delete
       if (edgeValidityFlag && simpleFlag) {
-        quickSort(EA, checkedEACount, edgeBothCmp());
-        quickSort(ED, checkedEDCount, edgeBothCmp());
+        sortBatch(EA, checkedEACount, bits, edgeBothCmp());
+        sortBatch(ED, checkedEDCount, bits, edgeBothCmp());
         checkedEACount = removeDuplicates(EA, checkedEACount, numEdges,
                                           symmetric, debugFlag);
         checkedEDCount = removeDuplicates(ED, checkedEDCount, numEdges,
@@ -468,12 +755,12 @@ public:
       free(EAflag);
       free(EDflag);
 #ifdef EDGEDATA
-      parallel_for(long i = 0; i < uncheckedEDCountOrig; i++) {
+      parallel_for(0, uncheckedEDCountOrig, [&](long i) {
         edgeWeightED[i].del();
-      }
-      parallel_for(long i = 0; i < uncheckedEACountOrig; i++) {
+      });
+      parallel_for(0, uncheckedEACountOrig, [&](long i) {
         edgeWeightEA[i].del();
-      }
+      });
 #endif
     } while (fixedBatchFlag && !streamClosed &&
              (checkedEACount + checkedEDCount) < numEdges);
@@ -497,6 +784,22 @@ public:
 #endif
   }
 
+  // Reads the next batch from the stream into the next_* buffer. Only reads
+  // the graph, so it can run concurrently with the engine's computation.
+  void readNextBatch() {
+    timer reading_timer;
+    reading_timer.start();
+    next_read_log.str("");
+    tie(next_edge_additions, next_edge_deletions, next_num_edges_read,
+        next_num_cancelled_edges) =
+        getNewEdgesFromFile(stream_file, max_batch_size, my_graph,
+                            my_graph.isSymmetric(), simple_flag,
+                            fixed_batch_flag, enforce_edge_validity_flag,
+                            debug_flag, stream_closed);
+    next_stream_position = stream_closed ? -1 : (long)stream_file.tellg();
+    next_reading_time = reading_timer.stop();
+  }
+
   bool processNextBatch() {
     current_batch++;
     if (current_batch > number_of_batches) {
@@ -507,19 +810,24 @@ public:
 
     timer timer1, timer2, fullTimer;
     fullTimer.start();
-    parallel_for(uintV i = 0; i < n; i++) updated_vertices[i] = 0;
+    parallel_for(0, n, [&](uintV i) { updated_vertices[i] = 0; });
 
     long num_edges_read_from_file;
-    long num_cancelled_edges;
 
     timer1.start();
-    tie(edge_additions, edge_deletions_temp, num_edges_read_from_file,
-        num_cancelled_edges) =
-        getNewEdgesFromFile(stream_file, max_batch_size, my_graph,
-                            my_graph.isSymmetric(), simple_flag,
-                            fixed_batch_flag, enforce_edge_validity_flag,
-                            debug_flag, stream_closed);
-    cout << "Reading Time : " << timer1.stop() << endl;
+    if (prefetch_pending) {
+      prefetch_task.join();
+      prefetch_pending = false;
+      cout << "Reading Stall Time : " << timer1.stop() << endl;
+    } else {
+      readNextBatch();
+    }
+    edge_additions = next_edge_additions;
+    edge_deletions_temp = next_edge_deletions;
+    num_edges_read_from_file = next_num_edges_read;
+    stream_position = next_stream_position;
+    cout << next_read_log.str();
+    cout << "Reading Time : " << next_reading_time << endl;
 
     if (stream_closed && num_edges_read_from_file == 0) {
       cout << "No Edges in Batch" << endl;
@@ -543,16 +851,26 @@ public:
     if (edge_additions.maxVertex >= n) {
       long n_new = edge_additions.maxVertex + 1;
       updated_vertices = renewA(bool, updated_vertices, n_new);
-      parallel_for(uintV i = my_graph.n; i < n_new; i++) {
+      parallel_for(my_graph.n, n_new, [&](uintV i) {
         updated_vertices[i] = 1;
-      }
+      });
       // update deletions_data
       deletions_data.updateNumVertices(n_new);
     }
     my_graph.addVertices(edge_additions.maxVertex);
     edge_additions = my_graph.addEdges(edge_additions, updated_vertices);
     cout << "Edge addition time : " << timer1.next() << "\n";
+    if (memory_report_flag) {
+      my_graph.printMemoryUsage();
+    }
     if ((edge_additions.size > 0) || (edge_deletions.size > 0)) {
+      if (pipeline_flag && !stream_closed &&
+          current_batch < number_of_batches) {
+        // The graph is not mutated again until the next call, so the next
+        // batch can be validated against it while the engine computes.
+        prefetch_pending = true;
+        prefetch_task.start([this]() { readNextBatch(); });
+      }
       return true;
     }
     cout << "No Edges in Stream" << endl;
@@ -31,6 +31,7 @@
 #include "graph/IO.h"
 #include "graph/graph.h"
 #include "graph/vertex.h"
+#include "graphBolt/checkpoint.h"
 using namespace std;
 
 template <class vertex> void compute(graph<vertex> &, commandLine);
@@ -44,9 +45,41 @@ int parallel_main(int argc, char *argv[]) {
   bool simpleFlag = P.getOptionValue("-simple");
   bool debugFlag = P.getOptionValue("-debug");
 
+  // When restoring, the graph is read from the checkpoint instead. It has
+  // already been simplified.
+  string restorePath = P.getOptionValue("-restore", "");
+  string checkpointGraph = checkpointGraphPath(restorePath);
+  if (!restorePath.empty()) {
+    iFile = &checkpointGraph[0];
+    simpleFlag = false;
+  }
+
   int n_workers = P.getOptionIntValue("-nWorkers", getWorkers());
   setCustomWorkers(n_workers);
 
+  AdjacencyCapacityPolicy capacityPolicy;
+  string policyName = P.getOptionValue("-adjacencyPolicy", "doubling");
+  if (!capacityPolicy.setType(policyName)) {
+    cout << "ERROR : Unknown -adjacencyPolicy. Expected exact, slack, doubling "
+            "or proportional\n";
+    exit(1);
+  }
+  capacityPolicy.slack = P.getOptionLongValue("-adjacencySlack", 10);
+  capacityPolicy.growth = P.getOptionDoubleValue("-adjacencyGrowth", 0.5);
+  bool memoryReport = P.getOptionValue("-memoryReport");
+
+  VertexOrder vertexOrder;
+  if (!vertexOrder.setType(P.getOptionValue("-reorder", "none"))) {
+    cout << "ERROR : Unknown -reorder. Expected none, degree or hub\n";
+    exit(1);
+  }
+  // Checkpoints hold the relabeled graph without the order
+  if (vertexOrder.type != input_order &&
+      (!restorePath.empty() || P.getOption("-checkpointPath"))) {
+    cout << "ERROR : -reorder cannot be used with checkpoints\n";
+    exit(1);
+  }
+
   cout << fixed;
 
   if (symmetric) {
@@ -54,14 +87,24 @@ int parallel_main(int argc, char *argv[]) {
     graph<symmetricVertex> G =
         readGraph<symmetricVertex>(iFile, symmetric, simpleFlag, debugFlag);
     G.setSymmetric(true);
+    G.setCapacityPolicy(capacityPolicy);
+    G.reorder(vertexOrder.type);
     cout << "Graph created" << endl;
+    if (memoryReport) {
+      G.printMemoryUsage();
+    }
     compute(G, P);
     G.del();
   } else {
     // asymmetric graph
     graph<asymmetricVertex> G =
         readGraph<asymmetricVertex>(iFile, symmetric, simpleFlag, debugFlag);
+    G.setCapacityPolicy(capacityPolicy);
+    G.reorder(vertexOrder.type);
     cout << "Graph created" << endl;
+    if (memoryReport) {
+      G.printMemoryUsage();
+    }
     compute(G, P);
     G.del();
   }
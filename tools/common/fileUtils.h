@@ -60,15 +60,17 @@ inline bool isSpace(char c) {
 // parallel code for converting a string to words
 words stringToWords(char *Str, unsigned long n) {
   {
-    parallel_for(unsigned long i = 0; i < n; i++) if (isSpace(Str[i])) Str[i] =
-        0;
+    parallel_for(0, n, [&](unsigned long i) {
+      if (isSpace(Str[i]))
+        Str[i] = 0;
+    });
   }
 
   // mark start of words
   bool *FL = newA(bool, n);
   FL[0] = Str[0];
   {
-    parallel_for(unsigned long i = 1; i < n; i++) FL[i] = Str[i] && !Str[i - 1];
+    parallel_for(1, n, [&](unsigned long i) { FL[i] = Str[i] && !Str[i - 1]; });
   }
 
   // offset for each start of word
@@ -78,7 +80,7 @@ words stringToWords(char *Str, unsigned long n) {
 
   // pointer to each start of word
   char **SA = newA(char *, m);
-  { parallel_for(unsigned long j = 0; j < m; j++) SA[j] = Str + offsets[j]; }
+  { parallel_for(0, m, [&](unsigned long j) { SA[j] = Str + offsets[j]; }); }
 
   free(offsets);
   free(FL);
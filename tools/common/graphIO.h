@@ -176,31 +176,31 @@ edgeArray remDuplicates(edgeArray A) {
   long m = A.nonZeros;
   edge *E = newA(edge, m);
   {
-    parallel_for(long i = 0; i < m; i++) {
+    parallel_for(0, m, [&](long i) {
       E[i].u = A.E[i].u;
       E[i].v = A.E[i].v;
-    }
+    });
   }
   quickSort(E, m, edgeCmp());
   long *flags = newA(long, m);
   flags[0] = 1;
   {
-    parallel_for(long i = 1; i < m; i++) {
+    parallel_for(1, m, [&](long i) {
       if ((E[i].u != E[i - 1].u) || (E[i].v != E[i - 1].v))
         flags[i] = 1;
       else
         flags[i] = 0;
-    }
+    });
   }
 
   long mm = sequence::plusScan(flags, flags, m);
   edge *F = newA(edge, mm);
   F[mm - 1] = E[m - 1];
   {
-    parallel_for(long i = 0; i < m - 1; i++) {
+    parallel_for(0, m - 1, [&](long i) {
       if (flags[i] != flags[i + 1])
         F[flags[i]] = E[i];
-    }
+    });
   }
   free(flags);
   free(E);
@@ -211,32 +211,32 @@ wghEdgeArray remDuplicates(wghEdgeArray A) {
   long m = A.nonZeros;
   wghEdge *E = newA(wghEdge, m);
   {
-    parallel_for(long i = 0; i < m; i++) {
+    parallel_for(0, m, [&](long i) {
       E[i].u = A.E[i].u;
       E[i].v = A.E[i].v;
       E[i].w = A.E[i].w;
-    }
+    });
   }
   quickSort(E, m, wghEdgeCmp());
   long *flags = newA(long, m);
   flags[0] = 1;
   {
-    parallel_for(long i = 1; i < m; i++) {
+    parallel_for(1, m, [&](long i) {
       if ((E[i].u != E[i - 1].u) || (E[i].v != E[i - 1].v))
         flags[i] = 1;
       else
         flags[i] = 0;
-    }
+    });
   }
 
   long mm = sequence::plusScan(flags, flags, m);
   wghEdge *F = newA(wghEdge, mm);
   F[mm - 1] = E[m - 1];
   {
-    parallel_for(long i = 0; i < m - 1; i++) {
+    parallel_for(0, m - 1, [&](long i) {
       if (flags[i] != flags[i + 1])
         F[flags[i]] = E[i];
-    }
+    });
   }
   free(flags);
   free(E);
@@ -256,10 +256,10 @@ edgeArray makeSymmetric(edgeArray A) {
   edge *E = A.E;
   edge *F = newA(edge, 2 * m);
   long mm = sequence::filter(E, F, m, nEQF());
-  parallel_for(long i = 0; i < mm; i++) {
+  parallel_for(0, mm, [&](long i) {
     F[i + mm].u = F[i].v;
     F[i + mm].v = F[i].u;
-  }
+  });
 
   edgeArray R = remDuplicates(edgeArray(F, A.numRows, A.numCols, 2 * mm));
   free(F);
@@ -272,11 +272,11 @@ wghEdgeArray makeSymmetric(wghEdgeArray A) {
   wghEdge *E = A.E;
   wghEdge *F = newA(wghEdge, 2 * m);
   long mm = sequence::filter(E, F, m, nEQFWgh());
-  parallel_for(long i = 0; i < mm; i++) {
+  parallel_for(0, mm, [&](long i) {
     F[i + mm].u = F[i].v;
     F[i + mm].v = F[i].u;
     F[i + mm].w = F[i].w;
-  }
+  });
 
   wghEdgeArray R = remDuplicates(wghEdgeArray(F, A.numRows, A.numCols, 2 * mm));
   free(F);
@@ -306,7 +306,7 @@ graph graphFromEdges(edgeArray EA, bool makeSym) {
     cout << "Make symmetric done\n";
   } else { // should have copy constructor
     edge *E = newA(edge, EA.nonZeros);
-    parallel_for(long i = 0; i < EA.nonZeros; i++) E[i] = EA.E[i];
+    parallel_for(0, EA.nonZeros, [&](long i) { E[i] = EA.E[i]; });
     A = edgeArray(E, EA.numRows, EA.numCols, EA.nonZeros);
   }
   long m = A.nonZeros;
@@ -316,15 +316,15 @@ graph graphFromEdges(edgeArray EA, bool makeSym) {
 
   // long *offsets = newA(long, n * 2);
   long *offsets = newA(long, n);
-  parallel_for(long i = 0; i < n; i++) { offsets[i] = m; }
+  parallel_for(0, n, [&](long i) { offsets[i] = m; });
 
-  parallel_for(long i = 0; i < m - 1; i++) {
+  parallel_for(0, m - 1, [&](long i) {
     uintV currV = A.E[i].u;
     uintV nextV = A.E[i + 1].u;
     if (currV != nextV) {
       offsets[nextV] = i + 1;
     }
-  }
+  });
   offsets[A.E[0].u] = 0;
   sequence::scanIBack(offsets, offsets, (long)n, minF<long>(), (long)m);
 
@@ -332,7 +332,7 @@ graph graphFromEdges(edgeArray EA, bool makeSym) {
   uintV *outEdges = newA(uintV, m);
   vertex *v = newA(vertex, n);
 
-  parallel_for(uintV i = 0; i < n; i++) {
+  parallel_for(0, n, [&](uintV i) {
     long o = offsets[i];
     long l = ((i == n - 1) ? m : offsets[i + 1]) - offsets[i];
     v[i].degree = l;
@@ -344,7 +344,7 @@ graph graphFromEdges(edgeArray EA, bool makeSym) {
       quickSort(v[i].Neighbors, l,
                 [](uintV val1, uintV val2) { return val1 < val2; });
     }
-  }
+  });
   A.del();
   EA.del();
   // free(offsets);
@@ -359,7 +359,7 @@ wghGraph wghGraphFromWghEdges(wghEdgeArray EA, bool makeSym) {
     cout << "Make symmetric done\n";
   } else { // should have copy constructor
     wghEdge *E = newA(wghEdge, EA.nonZeros);
-    parallel_for(long i = 0; i < EA.nonZeros; i++) E[i] = EA.E[i];
+    parallel_for(0, EA.nonZeros, [&](long i) { E[i] = EA.E[i]; });
     A = wghEdgeArray(E, EA.numRows, EA.numCols, EA.nonZeros);
   }
   long m = A.nonZeros;
@@ -368,15 +368,15 @@ wghGraph wghGraphFromWghEdges(wghEdgeArray EA, bool makeSym) {
   quickSort(A.E, m, [](wghEdge &val1, wghEdge &val2) { return val1.u < val2.u; });
   
   long *offsets = newA(long, n);
-  parallel_for(long i = 0; i < n; i++) { offsets[i] = m; }
+  parallel_for(0, n, [&](long i) { offsets[i] = m; });
 
-  parallel_for(long i = 0; i < m - 1; i++) {
+  parallel_for(0, m - 1, [&](long i) {
     uintV currV = A.E[i].u;
     uintV nextV = A.E[i + 1].u;
     if (currV != nextV) {
       offsets[nextV] = i + 1;
     }
-  }
+  });
   offsets[A.E[0].u] = 0;
   sequence::scanIBack(offsets, offsets, (long)n, minF<long>(), (long)m);
 
@@ -384,7 +384,7 @@ wghGraph wghGraphFromWghEdges(wghEdgeArray EA, bool makeSym) {
   char **outWeights = newA(char *, m);
   wghVertex *v = newA(wghVertex, n);
 
-  parallel_for(uintV i = 0; i < n; i++) {
+  parallel_for(0, n, [&](uintV i) {
     long o = offsets[i];
     long l = ((i == n - 1) ? m : offsets[i + 1]) - offsets[i];
     v[i].degree = l;
@@ -394,7 +394,7 @@ wghGraph wghGraphFromWghEdges(wghEdgeArray EA, bool makeSym) {
       v[i].Neighbors[j] = A.E[o + j].v;
       v[i].nghWeights[j] = A.E[o + j].w;
     }
-  }
+  });
   A.del();
   EA.del();
   // free(offsets);
@@ -442,12 +442,15 @@ struct toLong {
 
 // parallel code for converting a string to words
 words stringToWords(char *Str, unsigned long n) {
-  parallel_for(unsigned long i = 0; i < n; i++) if (isSpace(Str[i])) Str[i] = 0;
+  parallel_for(0, n, [&](unsigned long i) {
+    if (isSpace(Str[i]))
+      Str[i] = 0;
+  });
 
   // mark start of words
   bool *FL = newA(bool, n);
   FL[0] = Str[0];
-  parallel_for(unsigned long i = 1; i < n; i++) FL[i] = Str[i] && !Str[i - 1];
+  parallel_for(1, n, [&](unsigned long i) { FL[i] = Str[i] && !Str[i - 1]; });
 
   // offset for each start of word
   _seq<unsigned long> Off = sequence::packIndex<unsigned long>(FL, n);
@@ -457,7 +460,7 @@ words stringToWords(char *Str, unsigned long n) {
 
   // pointer to each start of word
   char **SA = newA(char *, m);
-  parallel_for(unsigned long j = 0; j < m; j++) SA[j] = Str + offsets[j];
+  parallel_for(0, m, [&](unsigned long j) { SA[j] = Str + offsets[j]; });
 
   free(offsets);
   return words(Str, n, SA, m);
@@ -508,14 +511,14 @@ struct notZero {
 
 template <class T> _seq<char> arrayToString(T *A, long n) {
   long *L = newA(long, n);
-  { parallel_for(long i = 0; i < n; i++) L[i] = xToStringLen(A[i]) + 1; }
+  { parallel_for(0, n, [&](long i) { L[i] = xToStringLen(A[i]) + 1; }); }
   long m = sequence::scan(L, L, n, addF<long>(), (long)0);
   char *B = newA(char, m);
-  parallel_for(long j = 0; j < m; j++) B[j] = 0;
-  parallel_for(long i = 0; i < n - 1; i++) {
+  parallel_for(0, m, [&](long j) { B[j] = 0; });
+  parallel_for(0, n - 1, [&](long i) {
     xToString(B + L[i], A[i]);
     B[L[i + 1] - 1] = '\n';
-  }
+  });
   xToString(B + L[n - 1], A[n - 1]);
   B[m - 1] = '\n';
   free(L);
@@ -601,7 +604,7 @@ int writeGraphToFile(graph G, char *fname) {
   long *offsets = newA(long, n);
   uintV *edges = newA(uintV, m);
 
-  parallel_for(long i = 0; i < n; i++) { offsets[i] = G.V[i].degree; }
+  parallel_for(0, n, [&](long i) { offsets[i] = G.V[i].degree; });
   long total = sequence::scan(offsets, offsets, n, addF<long>(), (long)0);
 
   for (long i = 0; i < n; i++) {
@@ -649,7 +652,7 @@ edgeArray readSNAP(char *fname) {
       break;
   }
 
-  parallel_for(unsigned long i = 0; i < S.n - k; i++) S2[i] = S.A[k + i];
+  parallel_for(0, S.n - k, [&](unsigned long i) { S2[i] = S.A[k + i]; });
   S.del();
 
   words W = stringToWords(S2, S.n - k);
@@ -657,12 +660,12 @@ edgeArray readSNAP(char *fname) {
   edge *E = newA(edge, n);
 
   {
-    parallel_for(unsigned long i = 0; i < n; i++) {
+    parallel_for(0, n, [&](unsigned long i) {
       // E[i] = edge(atol(W.Strings[2 * i]),
       // atol(W.Strings[2 * i + 1]));
       E[i].u = atol(W.Strings[2 * i]);
       E[i].v = atol(W.Strings[2 * i + 1]);
-    }
+    });
   }
   W.del();
 
@@ -689,17 +692,17 @@ wghEdgeArray readWghSNAP(char *fname) {
     if (k >= S.n || S.A[k] != '#')
       break;
   }
-  parallel_for(unsigned long i = 0; i < S.n - k; i++) S2[i] = S.A[k + i];
+  parallel_for(0, S.n - k, [&](unsigned long i) { S2[i] = S.A[k + i]; });
   S.del();
 
   words W = stringToWords(S2, S.n - k);
   unsigned long n = W.m / 3;
   wghEdge *E = newA(wghEdge, n);
   {
-    parallel_for(unsigned long i = 0; i < n; i++) {
+    parallel_for(0, n, [&](unsigned long i) {
       E[i] = wghEdge(atol(W.Strings[3 * i]), atol(W.Strings[3 * i + 1]),
                      W.Strings[3 * i + 2]);
-    }
+    });
   }
 
   unsigned long maxR = 0;
@@ -726,8 +729,14 @@ graph readGraphFromFile(char *fname) {
 
   long *offsets = newA(long, n);
   uintV *outEdges = newA(uintV, m);
-  { parallel_for(long i = 0; i < n; i++) offsets[i] = atol(W.Strings[i + 2 + 1]); }
-  { parallel_for(long i = 0; i < m; i++) outEdges[i] = atol(W.Strings[i + 2 + n + 1]); }
+  {
+    parallel_for(0, n,
+                 [&](long i) { offsets[i] = atol(W.Strings[i + 2 + 1]); });
+  }
+  {
+    parallel_for(0, m,
+                 [&](long i) { outEdges[i] = atol(W.Strings[i + 2 + n + 1]); });
+  }
 
   W.del();
 
@@ -739,12 +748,12 @@ graph readGraphFromFile(char *fname) {
 
   vertex *v = newA(vertex, n);
 
-  parallel_for(long i = 0; i < n; i++) {
+  parallel_for(0, n, [&](long i) {
     long o = offsets[i];
     long l = ((i == n - 1) ? m : offsets[i + 1]) - offsets[i];
     v[i].degree = l;
     v[i].Neighbors = (outEdges + o);
-  }
+  });
   return graph(v, n, m, offsets, outEdges);
 }
 